@@ -0,0 +1,13 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/crc_bench.dir/src/Bench/crc_bench.cpp.o"
+  "CMakeFiles/crc_bench.dir/src/Bench/crc_bench.cpp.o.d"
+  "CMakeFiles/crc_bench.dir/src/Protocol/Crc32.cpp.o"
+  "CMakeFiles/crc_bench.dir/src/Protocol/Crc32.cpp.o.d"
+  "crc_bench"
+  "crc_bench.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/crc_bench.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
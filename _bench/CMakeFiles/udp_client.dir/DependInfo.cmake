@@ -0,0 +1,24 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/src/Client/ChromaClient.cpp" "CMakeFiles/udp_client.dir/src/Client/ChromaClient.cpp.o" "gcc" "CMakeFiles/udp_client.dir/src/Client/ChromaClient.cpp.o.d"
+  "/root/repo/src/Protocol/ChromaProtocol.cpp" "CMakeFiles/udp_client.dir/src/Protocol/ChromaProtocol.cpp.o" "gcc" "CMakeFiles/udp_client.dir/src/Protocol/ChromaProtocol.cpp.o.d"
+  "/root/repo/src/Protocol/CongestionControl.cpp" "CMakeFiles/udp_client.dir/src/Protocol/CongestionControl.cpp.o" "gcc" "CMakeFiles/udp_client.dir/src/Protocol/CongestionControl.cpp.o.d"
+  "/root/repo/src/Protocol/Crc32.cpp" "CMakeFiles/udp_client.dir/src/Protocol/Crc32.cpp.o" "gcc" "CMakeFiles/udp_client.dir/src/Protocol/Crc32.cpp.o.d"
+  "/root/repo/src/Protocol/TimingWheel.cpp" "CMakeFiles/udp_client.dir/src/Protocol/TimingWheel.cpp.o" "gcc" "CMakeFiles/udp_client.dir/src/Protocol/TimingWheel.cpp.o.d"
+  "/root/repo/src/main_client.cpp" "CMakeFiles/udp_client.dir/src/main_client.cpp.o" "gcc" "CMakeFiles/udp_client.dir/src/main_client.cpp.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
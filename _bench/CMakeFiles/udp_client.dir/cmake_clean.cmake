@@ -0,0 +1,21 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/udp_client.dir/src/Client/ChromaClient.cpp.o"
+  "CMakeFiles/udp_client.dir/src/Client/ChromaClient.cpp.o.d"
+  "CMakeFiles/udp_client.dir/src/Protocol/ChromaProtocol.cpp.o"
+  "CMakeFiles/udp_client.dir/src/Protocol/ChromaProtocol.cpp.o.d"
+  "CMakeFiles/udp_client.dir/src/Protocol/CongestionControl.cpp.o"
+  "CMakeFiles/udp_client.dir/src/Protocol/CongestionControl.cpp.o.d"
+  "CMakeFiles/udp_client.dir/src/Protocol/Crc32.cpp.o"
+  "CMakeFiles/udp_client.dir/src/Protocol/Crc32.cpp.o.d"
+  "CMakeFiles/udp_client.dir/src/Protocol/TimingWheel.cpp.o"
+  "CMakeFiles/udp_client.dir/src/Protocol/TimingWheel.cpp.o.d"
+  "CMakeFiles/udp_client.dir/src/main_client.cpp.o"
+  "CMakeFiles/udp_client.dir/src/main_client.cpp.o.d"
+  "udp_client"
+  "udp_client.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/udp_client.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
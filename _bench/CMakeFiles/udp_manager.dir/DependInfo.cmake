@@ -0,0 +1,25 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/src/Protocol/ChromaProtocol.cpp" "CMakeFiles/udp_manager.dir/src/Protocol/ChromaProtocol.cpp.o" "gcc" "CMakeFiles/udp_manager.dir/src/Protocol/ChromaProtocol.cpp.o.d"
+  "/root/repo/src/Protocol/CongestionControl.cpp" "CMakeFiles/udp_manager.dir/src/Protocol/CongestionControl.cpp.o" "gcc" "CMakeFiles/udp_manager.dir/src/Protocol/CongestionControl.cpp.o.d"
+  "/root/repo/src/Protocol/Crc32.cpp" "CMakeFiles/udp_manager.dir/src/Protocol/Crc32.cpp.o" "gcc" "CMakeFiles/udp_manager.dir/src/Protocol/Crc32.cpp.o.d"
+  "/root/repo/src/Protocol/TimingWheel.cpp" "CMakeFiles/udp_manager.dir/src/Protocol/TimingWheel.cpp.o" "gcc" "CMakeFiles/udp_manager.dir/src/Protocol/TimingWheel.cpp.o.d"
+  "/root/repo/src/Server/ChromaServer.cpp" "CMakeFiles/udp_manager.dir/src/Server/ChromaServer.cpp.o" "gcc" "CMakeFiles/udp_manager.dir/src/Server/ChromaServer.cpp.o.d"
+  "/root/repo/src/Server/ChromaServiceHost.cpp" "CMakeFiles/udp_manager.dir/src/Server/ChromaServiceHost.cpp.o" "gcc" "CMakeFiles/udp_manager.dir/src/Server/ChromaServiceHost.cpp.o.d"
+  "/root/repo/src/main_manager.cpp" "CMakeFiles/udp_manager.dir/src/main_manager.cpp.o" "gcc" "CMakeFiles/udp_manager.dir/src/main_manager.cpp.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
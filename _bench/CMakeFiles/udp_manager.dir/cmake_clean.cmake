@@ -0,0 +1,23 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/udp_manager.dir/src/Protocol/ChromaProtocol.cpp.o"
+  "CMakeFiles/udp_manager.dir/src/Protocol/ChromaProtocol.cpp.o.d"
+  "CMakeFiles/udp_manager.dir/src/Protocol/CongestionControl.cpp.o"
+  "CMakeFiles/udp_manager.dir/src/Protocol/CongestionControl.cpp.o.d"
+  "CMakeFiles/udp_manager.dir/src/Protocol/Crc32.cpp.o"
+  "CMakeFiles/udp_manager.dir/src/Protocol/Crc32.cpp.o.d"
+  "CMakeFiles/udp_manager.dir/src/Protocol/TimingWheel.cpp.o"
+  "CMakeFiles/udp_manager.dir/src/Protocol/TimingWheel.cpp.o.d"
+  "CMakeFiles/udp_manager.dir/src/Server/ChromaServer.cpp.o"
+  "CMakeFiles/udp_manager.dir/src/Server/ChromaServer.cpp.o.d"
+  "CMakeFiles/udp_manager.dir/src/Server/ChromaServiceHost.cpp.o"
+  "CMakeFiles/udp_manager.dir/src/Server/ChromaServiceHost.cpp.o.d"
+  "CMakeFiles/udp_manager.dir/src/main_manager.cpp.o"
+  "CMakeFiles/udp_manager.dir/src/main_manager.cpp.o.d"
+  "udp_manager"
+  "udp_manager.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/udp_manager.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
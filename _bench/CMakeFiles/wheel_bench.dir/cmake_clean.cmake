@@ -0,0 +1,13 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/wheel_bench.dir/src/Bench/wheel_bench.cpp.o"
+  "CMakeFiles/wheel_bench.dir/src/Bench/wheel_bench.cpp.o.d"
+  "CMakeFiles/wheel_bench.dir/src/Protocol/TimingWheel.cpp.o"
+  "CMakeFiles/wheel_bench.dir/src/Protocol/TimingWheel.cpp.o.d"
+  "wheel_bench"
+  "wheel_bench.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/wheel_bench.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,144 @@
+#include "../Protocol/TimingWheel.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <queue>
+#include <random>
+#include <unordered_set>
+#include <vector>
+
+// Microbenchmark da roda de timers: arma N timers com atrasos de 1 a 8000 ms
+// (a faixa do RTO), cancela metade e avança o relógio de 1 em 1 ms até todos
+// dispararem, conferindo que cada um saiu exatamente no tick certo. Para
+// comparação roda a mesma carga no desenho antigo (priority_queue +
+// std::function + unordered_set de cancelados).
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr uint32_t MAX_DELAY_MS = 8000;
+
+struct FireCheck {
+    uint64_t now{0};
+    size_t fired{0};
+    size_t wrong{0};
+};
+
+void onFire(void* ctx, uint64_t delay) {
+    auto* check = static_cast<FireCheck*>(ctx);
+    check->fired++;
+    if (delay != check->now) check->wrong++;
+}
+
+double nsPer(Clock::duration d, size_t n) {
+    return std::chrono::duration<double, std::nano>(d).count() / static_cast<double>(n);
+}
+
+void printRow(const char* name, size_t n, Clock::duration arm, Clock::duration cancel,
+              Clock::duration fire, size_t fired) {
+    std::cout << std::left << std::setw(16) << name << std::right
+              << std::setw(10) << n
+              << std::setw(12) << std::fixed << std::setprecision(1) << nsPer(arm, n)
+              << std::setw(12) << nsPer(cancel, n / 2)
+              << std::setw(12) << nsPer(fire, std::max<size_t>(fired, 1))
+              << "\n";
+}
+
+bool benchWheel(size_t n, const std::vector<uint32_t>& delays, const std::vector<size_t>& cancelOrder) {
+    TimingWheel wheel(n);
+    FireCheck check;
+    std::vector<TimingWheel::Handle> handles(n);
+    auto base = Clock::now();
+
+    auto t0 = Clock::now();
+    for (size_t i = 0; i < n; ++i) {
+        handles[i] = wheel.schedule(delays[i], onFire, &check, delays[i], base);
+    }
+    auto t1 = Clock::now();
+    for (size_t i = 0; i < n / 2; ++i) {
+        wheel.cancel(handles[cancelOrder[i]]);
+    }
+    auto t2 = Clock::now();
+    for (uint32_t ms = 1; ms <= MAX_DELAY_MS; ++ms) {
+        check.now = ms;
+        wheel.advance(base + std::chrono::milliseconds(ms));
+    }
+    auto t3 = Clock::now();
+
+    // Handles já cancelados ou disparados não podem afetar nada
+    size_t stale = 0;
+    for (TimingWheel::Handle h : handles) stale += wheel.cancel(h) ? 1 : 0;
+
+    printRow("timing wheel", n, t1 - t0, t2 - t1, t3 - t2, check.fired);
+
+    if (check.fired != n - n / 2 || check.wrong != 0 || stale != 0 || wheel.pending() != 0) {
+        std::cerr << "Roda divergiu: disparados " << check.fired << " (esperado " << n - n / 2
+                  << "), fora do tick " << check.wrong << ", handles velhos ativos " << stale
+                  << ", pendentes " << wheel.pending() << "\n";
+        return false;
+    }
+    return true;
+}
+
+void benchHeap(size_t n, const std::vector<uint32_t>& delays, const std::vector<size_t>& cancelOrder) {
+    struct Task {
+        uint64_t expiry;
+        uint32_t id;
+        std::function<void()> cb;
+        bool operator>(const Task& o) const { return expiry > o.expiry; }
+    };
+    std::priority_queue<Task, std::vector<Task>, std::greater<Task>> pq;
+    std::unordered_set<uint32_t> cancelled;
+    FireCheck check;
+
+    auto t0 = Clock::now();
+    for (size_t i = 0; i < n; ++i) {
+        uint64_t delay = delays[i];
+        pq.push({delay, static_cast<uint32_t>(i), [&check, delay]() { onFire(&check, delay); }});
+    }
+    auto t1 = Clock::now();
+    for (size_t i = 0; i < n / 2; ++i) {
+        cancelled.insert(static_cast<uint32_t>(cancelOrder[i]));
+    }
+    auto t2 = Clock::now();
+    for (uint32_t ms = 1; ms <= MAX_DELAY_MS; ++ms) {
+        check.now = ms;
+        while (!pq.empty() && pq.top().expiry <= ms) {
+            Task task = std::move(const_cast<Task&>(pq.top()));
+            pq.pop();
+            if (cancelled.erase(task.id)) continue;
+            task.cb();
+        }
+    }
+    auto t3 = Clock::now();
+
+    printRow("heap (antigo)", n, t1 - t0, t2 - t1, t3 - t2, check.fired);
+}
+
+} // namespace
+
+int main() {
+    std::cout << std::left << std::setw(16) << "estrutura" << std::right
+              << std::setw(10) << "timers"
+              << std::setw(12) << "armar" << std::setw(12) << "cancelar" << std::setw(12) << "disparar"
+              << "   (ns/op)\n";
+
+    for (size_t n : {100'000UL, 1'000'000UL}) {
+        std::mt19937 rng(42);
+        std::uniform_int_distribution<uint32_t> dist(1, MAX_DELAY_MS);
+        std::vector<uint32_t> delays(n);
+        for (uint32_t& d : delays) d = dist(rng);
+
+        std::vector<size_t> cancelOrder(n);
+        for (size_t i = 0; i < n; ++i) cancelOrder[i] = i;
+        std::shuffle(cancelOrder.begin(), cancelOrder.end(), rng);
+
+        if (!benchWheel(n, delays, cancelOrder)) return 1;
+        benchHeap(n, delays, cancelOrder);
+    }
+    return 0;
+}
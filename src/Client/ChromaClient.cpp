@@ -27,12 +27,18 @@ void ChromaClient::connectToServer(const char* ip, int port) {
 
     connected = true;
     logMsg("Cliente conectado ao servidor " + std::string(ip) + ":" + std::to_string(port), GREEN);
+
+    // Os DATA chegam em rajada: com GRO o kernel entrega vários por leitura
+    if (!enableReceiveOffload()) {
+        logMsg("UDP_GRO indisponível, recebendo um datagrama por buffer.", YELLOW);
+    }
 }
 
 void ChromaClient::disconnect() {
     if (!connected) return;
 
     close(sockfd);
+    sockfd = -1;   // o destrutor da base não fecha de novo (o número pode já ser de outra thread)
     connected = false;
     serverAddr = {};
     serverResponseAddr = {};
@@ -46,34 +52,154 @@ void ChromaClient::sendData(const char* data, size_t len) {
     extensionFile = (pos != std::string::npos) ? fileRequested.substr(pos + 1) : "bin";
 
     logMsg("Solicitando arquivo: " + fileRequested, CYAN);
+    transferOk = false;
+
+    // O handshake é sempre feito no formato legado
+    setWireVersion(CHROMA_VERSION_LEGACY, maxWindowSize);
+
+    // Id da requisição: as retransmissões do GET repetem o mesmo valor, então
+    // o servidor reconhece a duplicata. Servidores antigos leem o nome só
+    // até o '\0' e ignoram o resto.
+    std::random_device rd;
+    requestId = (static_cast<uint64_t>(rd()) << 32 | rd()) | 1;
+
+    std::vector<char> requestPayload(data, data + len);
+    requestPayload.push_back('\0');
+    appendOption(requestPayload, "rid", std::to_string(requestId));
+    // Maior datagrama que os buffers aceitam: o servidor sonda o caminho até ele
+    appendOption(requestPayload, "dgram", std::to_string(maxDatagram()));
+    if (requestOffset != 0 || requestLength != UINT64_MAX) {
+        appendOption(requestPayload, "off", std::to_string(requestOffset));
+        appendOption(requestPayload, "len", std::to_string(requestLength));
+    }
+    if (signatureBlock > 0) {
+        appendOption(requestPayload, "sig", std::to_string(signatureBlock));
+    }
+    if (wantMerkleRoot) {
+        appendOption(requestPayload, "merkle", "1");
+    }
+    if (wantMerkleLeaves) {
+        appendOption(requestPayload, "leaves", "1");
+    }
+    if (offerCompression && !Codec::available().empty()) {
+        appendOption(requestPayload, "comp", Codec::available());
+    }
+    // Sabe reconstruir pacotes a partir das paridades; o servidor decide se manda
+    appendOption(requestPayload, "fec", "1");
 
-    Packet request(0, std::vector<char>(data, data + len), ChromaFlag::GET);
+    Packet request(0, std::move(requestPayload), ChromaFlag::GET);
     if (sendPacket(request, serverAddr) < 0) {
         throw std::runtime_error("Falha ao enviar requisição para o servidor");
     }
 
     int retries = 3;
+    int busyRetries = 0;
+    int busyBackoffMs = CHROMA_BUSY_RETRY_MS;
+    // Na fila do servidor: o GET é repetido (mesmo rid) a cada dica para
+    // manter o lugar, até o META chegar ou o prazo total vencer
+    bool queued = false;
+    bool preparing = false;
+    int keepaliveMs = CHROMA_CONTACT_TIMEOUT_MS;
+    auto queueDeadline = std::chrono::steady_clock::time_point::max();
     Packet pkt;
     while (retries-- > 0) {
-        if (waitResponse(5) && recvPacket(pkt) > 0) {
+        if (waitResponseMs(queued ? keepaliveMs : CHROMA_CONTACT_TIMEOUT_MS) && recvPacket(pkt) > 0) {
             if (pkt.flag == ChromaFlag::META && !isCorrupted(pkt)) {
                 serverResponseAddr = pkt.srcAddr;
                 readFileMetadata(pkt);
 
-                Packet ackMeta(0, {}, ChromaFlag::ACK);
+                // Servidor antigo não anuncia versão: ACK vazio mantém o formato legado
+                std::vector<char> ackOptions;
+                uint32_t window = std::min(maxWindowSize, serverWindow);
+                if (serverVersion == CHROMA_VERSION_WIDE) {
+                    appendOption(ackOptions, "v", std::to_string(CHROMA_VERSION_WIDE));
+                    appendOption(ackOptions, "win", std::to_string(window));
+                }
+                // Repetir o codec confirma a compressão; sem isso só chega DATA
+                if (codec) {
+                    appendOption(ackOptions, "comp", codec->name());
+                }
+
+                Packet ackMeta(0, std::move(ackOptions), ChromaFlag::ACK);
                 sendPacket(ackMeta, serverResponseAddr);
+                setWireVersion(serverVersion, window);
                 logMsg("Contato estabelecido com a thread do servidor.", GREEN);
-                bufferPackets.clear();
+                bufferPackets.reset(windowSize, 0);   // só marca presença; o payload vai para o disco
                 base = 0;
                 nextSeqNum = 0;
                 receiveData();
                 return;
             }
+            else if (pkt.flag == ChromaFlag::PROBE && !isCorrupted(pkt)) {
+                // Sonda de PMTU chegou inteira: devolve o seq para o servidor
+                std::vector<char> probeAck;
+                appendOption(probeAck, "size", std::to_string(pkt.data.size() + CHROMA_HEADER_SIZE));
+                sendPacket(pkt.seqNum, ChromaFlag::PROBE, probeAck, pkt.srcAddr);
+                retries++;   // sonda não conta como falha de contato
+                continue;
+            }
             else if (pkt.flag == ChromaFlag::NACK) {
                 std::string errMsg(pkt.data.begin(), pkt.data.end());
                 logMsg("Servidor respondeu com erro: " + errMsg, RED);
                 return;                
             }
+            else if (pkt.flag == ChromaFlag::BUSY && !isCorrupted(pkt)) {
+                Options options = parseOptions(pkt.data, 0);
+                int hintMs = 0;
+                if (auto retry = options.find("retry"); retry != options.end()) {
+                    hintMs = std::atoi(retry->second.c_str());
+                }
+
+                // Na fila não há o que recuar: o META pode vir a qualquer momento
+                // Posição 0: a sessão já existe e prepara o arquivo (assinatura, Merkle)
+                if (auto position = options.find("queued"); position != options.end()) {
+                    bool nowPreparing = position->second == "0";
+                    if (nowPreparing && !preparing) {
+                        logMsg("Servidor preparando o arquivo, aguardando.", YELLOW);
+                    } else if (!nowPreparing && !queued) {
+                        logMsg("Servidor lotado, pedido na fila (posição " + position->second + ").", YELLOW);
+                    }
+                    preparing = nowPreparing;
+                    if (!queued) {
+                        queued = true;
+                        queueDeadline = std::chrono::steady_clock::now() +
+                                        std::chrono::milliseconds(CHROMA_QUEUE_DEADLINE_MS);
+                    }
+                    keepaliveMs = std::clamp(hintMs, CHROMA_BUSY_RETRY_MS, CHROMA_CONTACT_TIMEOUT_MS);
+                    retries++;
+                    continue;
+                }
+
+                if (busyRetries++ >= CHROMA_MAX_BUSY_RETRIES) {
+                    logMsg("Servidor continua lotado. Desistindo.", RED);
+                    return;
+                }
+
+                // Fora da fila (recusado) o pedido deixou de existir no servidor
+                queued = false;
+
+                // Espera o maior entre a dica do servidor e o próprio backoff
+                // exponencial, com jitter para os clientes recusados não voltarem juntos
+                int waitMs = std::max(hintMs, busyBackoffMs);
+                waitMs += rand() % (waitMs / 4 + 1);
+                busyBackoffMs = std::min(busyBackoffMs * 2, CHROMA_BUSY_BACKOFF_MAX_MS);
+
+                logMsg("Servidor lotado, tentando de novo em " + std::to_string(waitMs) + " ms.", YELLOW);
+                std::this_thread::sleep_for(std::chrono::milliseconds(waitMs));
+
+                retries++;   // BUSY não conta como falha de contato
+                sendPacket(request, serverAddr);
+                continue;
+            }
+        }
+        if (queued) {
+            if (std::chrono::steady_clock::now() >= queueDeadline) {
+                logMsg("Tempo máximo na fila do servidor esgotado. Desistindo.", RED);
+                return;
+            }
+            retries++;   // só renova o lugar na fila
+            sendPacket(request, serverAddr);
+            continue;
         }
         logMsg("Falha ao estabelecer contato com o servidor", RED);
         
@@ -85,98 +211,292 @@ void ChromaClient::receiveData() {
     logMsg("Aguardando pacotes do servidor...", CYAN);
 
     bool transmissionEnded = false;
-    std::ofstream file(("arquivo_reconstruido_" + filename + "." + extensionFile).c_str(),
-                       std::ios::out | std::ios::binary);
-    if (!file.is_open()) {
-        throw std::runtime_error("Erro ao criar arquivo de saída");
-    }
+    bool notFound = false;
+    writer = std::make_unique<DiskWriter>(outputPath(), static_cast<uint64_t>(fileSize), chunkSize,
+                                          createOutput, journal);
+    baseIndex = 0;
+    int timeouts = 0;
 
     long long bytesReceived = 0;  
     int packetsReceivedCount = 0; 
 
+    std::array<PacketView, CHROMA_BATCH_SIZE> views;
+    std::vector<OutgoingPacket> pendingAcks;
+    pendingAcks.reserve(CHROMA_BATCH_SIZE);
+
+    // No formato largo as confirmações são SACKs agrupados: um a cada
+    // CHROMA_ACK_EVERY pacotes, imediatamente diante de buraco/duplicata,
+    // ou quando o atraso máximo vence.
+    const bool useSack = wireVersion == CHROMA_VERSION_WIDE;
+    uint32_t unackedPackets = 0;
+    bool ackNow = false;
+    auto ackDeadline = std::chrono::steady_clock::time_point::max();
+    highestReceived = base;
+
+    // Paridades (se o servidor manda) reconstroem pacotes perdidos sem
+    // esperar a retransmissão
+    fec.reset();
+    if (fecBlock > 0) {
+        fec = std::make_unique<FecDecoder>(fecBlock, chunkSize);
+    }
+    std::vector<FecDecoder::Recovered> recovered;
+
+    // Grava um pacote novo da janela (recebido ou reconstruído) e avança a
+    // base; false se ele cai fora do trecho
+    auto deliver = [&](uint32_t seq, ChromaFlag flag, std::span<const char> data) -> bool {
+        bool zipped = flag == ChromaFlag::ZDATA;
+        logMsg("Pacote Seq=" + std::to_string(seq) +
+               " (" + std::to_string(data.size()) + " bytes) recebido.", BLUE);
+
+        if (!isSeqInWindow(highestReceived, base) ||
+            getSeqDistance(base, seq) > getSeqDistance(base, highestReceived)) {
+            highestReceived = seq;
+        }
+
+        // Payload maior que o chunk negociado não cabe no offset dele: é
+        // descartado inteiro em vez de gravado pela metade
+        if (data.size() > chunkSize) {
+            logErr("Pacote Seq=" + std::to_string(seq) + " maior que o chunk (" +
+                   std::to_string(chunkSize) + " bytes) descartado.", YELLOW);
+            return false;
+        }
+
+        // Todo pacote menos o último tem o tamanho de chunk, então o
+        // offset sai do índice absoluto; o último termina no fim do trecho.
+        // ZDATA não revela o tamanho cru, que sai do índice e do chunk.
+        uint64_t index = baseIndex + getSeqDistance(base, seq);
+        uint64_t length = data.size();
+        uint64_t offset = 0;
+        if (zipped) {
+            offset = rangeStart + index * chunkSize;
+            length = offset < rangeStart + rangeBytes
+                ? std::min<uint64_t>(chunkSize, rangeStart + rangeBytes - offset) : 0;
+        } else {
+            offset = rangeStart + ((index + 1 == static_cast<uint64_t>(totalPackets))
+                                   ? rangeBytes - std::min(rangeBytes, length)
+                                   : index * chunkSize);
+        }
+        if ((zipped && length == 0) || offset + length > rangeStart + rangeBytes) {
+            logErr("Pacote Seq=" + std::to_string(seq) + " fora do arquivo descartado.", YELLOW);
+            return false;
+        }
+
+        // Em ordem ou não, vai direto para o offset pelo writer
+        if (zipped) writer->write(offset, data, codec, static_cast<uint32_t>(length));
+        else writer->write(offset, data);
+        packetsReceivedCount++;
+        bytesReceived += static_cast<long long>(length);
+
+        if (seq == base) {
+            base = nextSeq(base);
+            baseIndex++;
+        } else {
+            bufferPackets.acquire(seq, flag);
+            ackNow = true;   // buraco na sequência: avisa o servidor já
+        }
+
+        // O bitmap de ocupação diz quantos pacotes seguidos já chegaram
+        for (size_t run = bufferPackets.contiguousFrom(base); run > 0; --run) {
+            bufferPackets.erase(base);
+            base = nextSeq(base);
+            baseIndex++;
+        }
+        if (fec) fec->release(baseIndex);
+        printProgress(bytesReceived, static_cast<long long>(rangeBytes), packetsReceivedCount, totalPackets);
+
+        if (useSack) {
+            if (unackedPackets++ == 0) {
+                ackDeadline = std::chrono::steady_clock::now() +
+                              std::chrono::milliseconds(CHROMA_DELAYED_ACK_MS);
+            }
+        } else {
+            pendingAcks.emplace_back(seq, ChromaFlag::ACK);
+        }
+        return true;
+    };
+
+    // Entrega o que a última chamada ao decodificador reconstruiu
+    auto deliverRecovered = [&]() {
+        for (const FecDecoder::Recovered& packet : recovered) {
+            if (packet.index < baseIndex || packet.index - baseIndex >= windowSize) continue;
+            uint32_t seq = (base + static_cast<uint32_t>(packet.index - baseIndex)) & seqMask;
+            if (bufferPackets.contains(seq)) continue;
+            if (packet.flag == ChromaFlag::ZDATA && !codec) continue;
+
+            logMsg("Pacote Seq=" + std::to_string(seq) + " reconstruído pela FEC.", GREEN);
+            deliver(seq, packet.flag, packet.payload);
+        }
+    };
+
     while (!transmissionEnded) {
-        Packet pkt;
+        int waitMs = CHROMA_RECEIVE_TIMEOUT_MS;
+        if (unackedPackets > 0) {
+            auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+                ackDeadline - std::chrono::steady_clock::now()).count();
+            waitMs = static_cast<int>(std::max<long long>(remaining, 0));
+        }
 
-       if (!waitResponse(10) || recvPacket(pkt) <= 0) {
-            if (bytesReceived >= fileSize) {
+        if (!waitResponseMs(waitMs)) {
+            if (unackedPackets > 0) {
+                sendSack();
+                unackedPackets = 0;
+                continue;
+            }
+            if (bytesReceived >= static_cast<long long>(rangeBytes)) {
                 logMsg("Timeout, mas já recebemos todo o arquivo. Encerrando.", YELLOW);
                 transmissionEnded = true;
                 break;
+            } else if (++timeouts >= CHROMA_MAX_RECEIVE_TIMEOUTS) {
+                // O que já foi gravado fica no diário; um novo pedido retoma daqui
+                logErr("Servidor sem resposta. Desistindo do trecho.");
+                break;
             } else {
                 logErr("Timeout sem receber todos os pacotes. Tentando mais...");
                 continue; 
             }
         }
+        timeouts = 0;
 
-        if (isCorrupted(pkt)) {
-            logErr("Pacote corrompido descartado.", YELLOW);
+        int received = recvBatch(views);
+        if (received <= 0) {
             continue;
         }
 
-        
-        switch (pkt.flag) {
-            case ChromaFlag::DATA: {
-                if (isSeqInWindow(pkt.seqNum, base)) {
-                    if (bufferPackets.find(pkt.seqNum) != bufferPackets.end()) {
+        pendingAcks.clear();
+
+        for (int i = 0; i < received; ++i) {
+            const PacketView& pkt = views[i];
+
+            if (isCorrupted(pkt)) {
+                logErr("Pacote corrompido descartado.", YELLOW);
+                continue;
+            }
+
+            switch (pkt.flag) {
+                case ChromaFlag::DATA:
+                case ChromaFlag::ZDATA: {
+                    if (pkt.flag == ChromaFlag::ZDATA && !codec) {
+                        logErr("ZDATA sem codec negociado descartado.", YELLOW);
+                        break;
+                    }
+
+                    if (!isSeqInWindow(pkt.seqNum, base)) {
+                        // Já gravado: a confirmação anterior se perdeu, então confirma de novo
+                        if (getSeqDistance(pkt.seqNum, base) <= windowSize) {
+                            if (useSack) ackNow = true;
+                            else pendingAcks.emplace_back(pkt.seqNum, ChromaFlag::ACK);
+                        }
+                        break;
+                    }
+
+                    if (bufferPackets.contains(pkt.seqNum)) {
                         logMsg("Pacote duplicado Seq=" + std::to_string(pkt.seqNum) + " → reenviando ACK.", MAGENTA);
-                        sendConfirmation(pkt.seqNum, ChromaFlag::ACK, serverResponseAddr);
+                        if (useSack) ackNow = true;
+                        else pendingAcks.emplace_back(pkt.seqNum, ChromaFlag::ACK);
                         break;
                     }
-                    
+                
                     if(isPacketLost())
                     {
                         logErr("Simulação de perda de pacote Seq=" + std::to_string(pkt.seqNum), ORANGE);
                         continue;
                     }
 
-                    bufferPackets.insert({pkt.seqNum, pkt});
-                    logMsg("Pacote Seq=" + std::to_string(pkt.seqNum) +
-                           " (" + std::to_string(pkt.data.size()) + " bytes) recebido.", BLUE);
-
-                    while (bufferPackets.find(base) != bufferPackets.end()) {
-                        Packet& inOrder = bufferPackets[base];
-                        file.write(inOrder.data.data(), inOrder.data.size());
-                        packetsReceivedCount++;
-                        bytesReceived += inOrder.data.size();
-                        bufferPackets.erase(base);
-                        base++;
-                        
+                    uint64_t index = baseIndex + getSeqDistance(base, pkt.seqNum);
+                    if (deliver(pkt.seqNum, pkt.flag, pkt.data) && fec) {
+                        fec->onData(index, pkt.flag, pkt.data, recovered);
+                        deliverRecovered();
                     }
-                    printProgress(bytesReceived, fileSize, packetsReceivedCount, totalPackets);
-                    
-                    sendConfirmation(pkt.seqNum, ChromaFlag::ACK, serverResponseAddr);
+                    break;
                 }
+
+                case ChromaFlag::FEC:
+                    if (!fec) break;
+                    if (isPacketLost()) {
+                        logErr("Simulação de perda da paridade Seq=" + std::to_string(pkt.seqNum), ORANGE);
+                        continue;
+                    }
+                    if (!fec->onParity(pkt.data, recovered)) {
+                        logErr("Paridade inválida descartada.", YELLOW);
+                        break;
+                    }
+                    deliverRecovered();
                 break;
-            }
             
-            case ChromaFlag::END:
-                logMsg("Fim de transmissão recebido.", GREEN);
-                if (packetsReceivedCount >= totalPackets || bytesReceived >= fileSize) {
+                case ChromaFlag::END:
+                    logMsg("Fim de transmissão recebido.", GREEN);
+                    if (packetsReceivedCount >= totalPackets || bytesReceived >= static_cast<long long>(rangeBytes)) {
+                        transmissionEnded = true;
+                    } else {
+                        logErr("Recebido END antes de completar todos os pacotes! Continuando até timeout...");
+                    }
+                break;
+
+                case ChromaFlag::NACK:
+                    logErr("Servidor interrompeu o envio: " +
+                           std::string(pkt.data.begin(), pkt.data.end()));
                     transmissionEnded = true;
-                } else {
-                    logErr("Recebido END antes de completar todos os pacotes! Continuando até timeout...");
-                }
-            break;
+                    notFound = true;
+                break;
 
-            case ChromaFlag::NACK:
-                logErr("Servidor não encontrou o arquivo.");
-                transmissionEnded = true;
-            break;
+                default:
+                    logErr("Flag desconhecida ignorada.", YELLOW);
+                break;
+            }
+        }
 
-            default:
-                logErr("Flag desconhecida ignorada.", YELLOW);
-            break;
+        if (useSack) {
+            // Um único SACK cobre o lote inteiro
+            if (ackNow || unackedPackets >= CHROMA_ACK_EVERY) {
+                sendSack();
+                unackedPackets = 0;
+                ackNow = false;
+            }
+        } else if (!pendingAcks.empty() && sendBatch(pendingAcks, serverResponseAddr) < 0) {
+            // Legado: todos os ACKs do lote saem juntos em um sendmmsg
+            logErr("Erro ao enviar confirmações.");
         }
     }
 
-    file.flush();
-    if (bytesReceived < fileSize) {
+    bool written = writer->finish();
+    if (!written) {
+        logErr("Erro ao gravar o arquivo de saída.");
+    }
+    writer.reset();
+
+    if (bytesReceived < static_cast<long long>(rangeBytes)) {
         logErr("Arquivo incompleto! Recebido " + std::to_string(bytesReceived) +
-            " de " + std::to_string(fileSize) + " bytes.");
-    } else {
+            " de " + std::to_string(rangeBytes) + " bytes.");
+    } else if (!notFound) {
         logMsg("Arquivo salvo com sucesso!", GREEN);
     }
-    file.close();
+    if (fec && fec->recoveredCount() > 0) {
+        logMsg("FEC: " + std::to_string(fec->recoveredCount()) + " pacotes reconstruídos sem retransmissão.", GREEN);
+    }
+    transferOk = written && !notFound && bytesReceived >= static_cast<long long>(rangeBytes);
+}
+
+void ChromaClient::sendSack() {
+    // O bitmap só precisa ir até o maior seq recebido fora de ordem
+    size_t span = 0;
+    if (!bufferPackets.empty() && isSeqInWindow(highestReceived, base)) {
+        span = std::min<size_t>(getSeqDistance(base, highestReceived), CHROMA_SACK_MAX_BITS);
+    }
+
+    SackView::encodeHeader(sackPayload, base, (span + 7) / 8);
+    for (size_t i = 0; i < span; ++i) {
+        if (bufferPackets.contains((base + 1 + static_cast<uint32_t>(i)) & seqMask)) {
+            SackView::setBit(sackPayload, i);
+        }
+    }
+    // O servidor soma o que a FEC recuperou à perda que ele mesmo vê
+    if (fec) {
+        appendOption(sackPayload, "rec", std::to_string(fec->recoveredCount()));
+    }
+
+    if (sendPacket(base, ChromaFlag::SACK, sackPayload, serverResponseAddr) < 0) {
+        logErr("Erro ao enviar SACK.");
+    }
 }
 
 void ChromaClient::readFileMetadata(const Packet& pkt) {
@@ -196,16 +516,65 @@ void ChromaClient::readFileMetadata(const Packet& pkt) {
     fileSize = std::stoll(sizeStr);
     totalPackets = std::stoi(totalStr);
 
+    Options options = parseOptions(pkt.data, 4);
+    // Sem "off"/"len" o servidor manda o arquivo inteiro
+    rangeServed = options.count("off") && options.count("len");
+    rangeStart = options.count("off") ? std::stoull(options["off"]) : 0;
+    rangeBytes = options.count("len") ? std::stoull(options["len"]) : static_cast<uint64_t>(fileSize);
+    if (rangeStart > static_cast<uint64_t>(fileSize) || rangeBytes > static_cast<uint64_t>(fileSize) - rangeStart) {
+        throw std::runtime_error("Trecho inválido nos metadados.");
+    }
+    fileVersion = options.count("ver") ? options["ver"] : "";
+    // Servidor sem delta sync ignora "sig" e mandaria o arquivo inteiro
+    if (signatureBlock > 0 && options["sig"] != std::to_string(signatureBlock)) {
+        throw std::runtime_error("Servidor não oferece assinaturas de blocos.");
+    }
+    if (wantMerkleLeaves && options["leaves"] != "1") {
+        throw std::runtime_error("Servidor não oferece árvore de Merkle.");
+    }
+    merkleRoot = options.count("root") ? options["root"] : "";
+    codec = offerCompression && options.count("comp") ? Codec::find(options["comp"]) : nullptr;
+    fecBlock = options.count("fec")
+        ? std::min<uint32_t>(static_cast<uint32_t>(std::stoul(options["fec"])), CHROMA_FEC_MAX_BLOCK) : 0;
+    serverVersion = CHROMA_VERSION_LEGACY;
+    serverWindow = WINDOW_SIZE;
+    if (options.count("v") && options["v"] == std::to_string(CHROMA_VERSION_WIDE)) {
+        serverVersion = CHROMA_VERSION_WIDE;
+        serverWindow = options.count("win")
+            ? static_cast<uint32_t>(std::clamp<unsigned long>(std::stoul(options["win"]), 1, MAX_WIDE_WINDOW_SIZE))
+            : maxWindowSize;
+    }
+    // O chunk é payload: cabe no maior datagrama aceito menos o cabeçalho
+    // do formato do servidor. Chunk 0 faria todo DATA ser recusado.
+    chunkSize = options.count("chunk")
+        ? std::min<size_t>(std::stoul(options["chunk"]), maxDatagram() - Packet::headerSize(serverVersion))
+        : CHROMA_LEGACY_MAX_DATA;
+    if (chunkSize == 0) {
+        throw std::runtime_error("Chunk inválido nos metadados.");
+    }
+
     logMsg("Metadados recebidos:", GREEN);
     logMsg("Arquivo: " + filename);
     logMsg("Extensão: " + extensionFile);
     logMsg("Tamanho: " + std::to_string(fileSize) + " bytes");
     logMsg("Pacotes esperados: " + std::to_string(totalPackets));
+    logMsg("Chunk: " + std::to_string(chunkSize) + " bytes");
+    if (rangeBytes != static_cast<uint64_t>(fileSize)) {
+        logMsg("Trecho: " + std::to_string(rangeBytes) + " bytes a partir de " + std::to_string(rangeStart));
+    }
+    logMsg("Protocolo: v" + std::to_string(serverVersion) +
+           " (janela do servidor: " + std::to_string(serverWindow) + ")");
+    if (codec) {
+        logMsg(std::string("Compressão: ") + codec->name());
+    }
+    if (fecBlock > 0) {
+        logMsg("FEC: blocos de " + std::to_string(fecBlock) + " pacotes");
+    }
 }
 
 void ChromaClient::printProgress(long long bytesSent, long long fileSize,
                                  int packetsSent, int totalPackets) {
-    if (fileSize <= 0) return;
+    if (quietMode || fileSize <= 0) return;
 
     // Calcula progresso
     double progress = (double)bytesSent / fileSize * 100.0;
@@ -1,11 +1,27 @@
 #pragma once
 
 #include "../Protocol/ChromaProtocol.hpp"
+#include "../Protocol/Compression.hpp"
+#include "../Protocol/ErasureCode.hpp"
+#include "DiskWriter.hpp"
+#include "TransferJournal.hpp"
 #include <string>
 #include <fstream>
 #include <sstream>
 #include <iostream>
 #include <cstring>
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <random>
+#include <thread>
+
+constexpr int CHROMA_MAX_BUSY_RETRIES = 10;
+constexpr int CHROMA_BUSY_BACKOFF_MAX_MS = 8000;
+constexpr int CHROMA_CONTACT_TIMEOUT_MS = 5000;   // espera pelo META a cada GET
+constexpr int CHROMA_QUEUE_DEADLINE_MS = 120000;  // tempo máximo na fila do servidor
+constexpr int CHROMA_RECEIVE_TIMEOUT_MS = 10000;
+constexpr int CHROMA_MAX_RECEIVE_TIMEOUTS = 3;   // timeouts seguidos até desistir do trecho
 
 class ChromaClient : public ChromaProtocol {
 private:
@@ -19,6 +35,35 @@ private:
     long long fileSize = 0;
     int packetsReceived = 0;
     int totalPackets = 0;
+    uint8_t serverVersion = CHROMA_VERSION_LEGACY;
+    uint32_t serverWindow = WINDOW_SIZE;
+    size_t chunkSize = CHROMA_MAX_DATA;     // payload máximo por DATA, vindo do META
+    uint64_t requestId = 0;
+
+    // Trecho pedido no GET (padrão: arquivo inteiro) e o que o META diz servir
+    uint64_t requestOffset = 0;
+    uint64_t requestLength = UINT64_MAX;
+    bool createOutput = true;               // trunca e pré-aloca a saída
+    uint64_t rangeStart = 0;
+    uint64_t rangeBytes = 0;
+    bool rangeServed = false;               // META trouxe "off"/"len": o servidor atende trechos
+    bool transferOk = false;
+    std::string fileVersion;                // identidade do arquivo no servidor ("ver")
+    uint32_t signatureBlock = 0;            // >0: pede a assinatura de blocos ("sig")
+    bool wantMerkleRoot = false;            // pede a raiz da árvore de Merkle ("merkle")
+    bool wantMerkleLeaves = false;          // pede as folhas no lugar do arquivo ("leaves")
+    std::string merkleRoot;                 // hex, do META
+    bool offerCompression = true;           // oferece os codecs no GET ("comp")
+    const Codec* codec = nullptr;           // escolhido pelo servidor no META
+    uint32_t fecBlock = 0;                  // pacotes por bloco de FEC ("fec" do META)
+    std::unique_ptr<FecDecoder> fec;
+    std::string outputOverride;
+    std::shared_ptr<TransferJournal> journal;
+
+    std::vector<char> sackPayload;
+    uint32_t highestReceived = 0;
+    uint64_t baseIndex = 0;                 // índice absoluto do pacote em `base`
+    std::unique_ptr<DiskWriter> writer;
 
     int chanceLossPacket = 0; 
 
@@ -51,9 +96,52 @@ public:
     void connectToServer(const char* ip, int port);
     void disconnect();
 
+    // Pede só os bytes [offset, offset + length) do arquivo, gravados no
+    // mesmo offset da saída. Com createFile false a saída já deve existir
+    // (outro stream a criou) e não é truncada.
+    void setRange(uint64_t offset, uint64_t length, bool createFile) {
+        requestOffset = offset;
+        requestLength = length;
+        createOutput = createFile;
+    }
+
+    // Pede a assinatura de blocos do arquivo (delta sync) em vez do conteúdo;
+    // ela é gravada em `path`
+    void requestSignature(uint32_t blockSize, std::string path) {
+        signatureBlock = blockSize;
+        outputOverride = std::move(path);
+    }
+
+    // Pede a raiz da árvore de Merkle do arquivo no META
+    void requestMerkleRoot() { wantMerkleRoot = true; }
+
+    // Pede as folhas da árvore de Merkle em vez do conteúdo, gravadas em `path`
+    void requestMerkleLeaves(std::string path) {
+        wantMerkleLeaves = true;
+        outputOverride = std::move(path);
+    }
+
+    // Desliga a oferta de compressão por chunk no GET
+    void setCompression(bool enabled) { offerCompression = enabled; }
+
+    // Diário que registra o que for gravado, para retomar depois de uma queda
+    void setJournal(std::shared_ptr<TransferJournal> transferJournal) { journal = std::move(transferJournal); }
+
+    [[nodiscard]] bool transferComplete() const { return transferOk; }
+    // false para servidor sem GET por trecho: ele mandou o arquivo inteiro
+    [[nodiscard]] bool servesRanges() const { return rangeServed; }
+    [[nodiscard]] long long getFileSize() const { return fileSize; }
+    [[nodiscard]] const std::string& getFileVersion() const { return fileVersion; }
+    [[nodiscard]] const std::string& getMerkleRoot() const { return merkleRoot; }
+    [[nodiscard]] std::string outputPath() const {
+        if (!outputOverride.empty()) return outputOverride;
+        return "arquivo_reconstruido_" + filename + "." + extensionFile;
+    }
+
     bool isConnected() const { return connected; }
     void setQuietMode(bool quiet) { quietMode = quiet; }
 
     void readFileMetadata(const Packet& pkt);
+    void sendSack();
     void printProgress(long long bytesSent, long long fileSize, int packetsSent, int totalPackets);
 };
\ No newline at end of file
@@ -0,0 +1,81 @@
+#include "ChunkVerifier.hpp"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+ChunkVerifier::ChunkVerifier(std::string path, MerkleTree tree, ResultCallback onResult, size_t threads)
+    : path(std::move(path)), tree(std::move(tree)), onResult(std::move(onResult))
+{
+    threads = std::max<size_t>(threads, 1);
+    workers.reserve(threads);
+    for (size_t i = 0; i < threads; ++i) {
+        workers.emplace_back([this]() { loop(); });
+    }
+}
+
+ChunkVerifier::~ChunkVerifier() {
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread& t : workers) t.join();
+}
+
+void ChunkVerifier::submit(uint64_t block) {
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        queue.push_back(block);
+    }
+    wake.notify_one();
+}
+
+void ChunkVerifier::drain() {
+    std::unique_lock<std::mutex> lock(mtx);
+    idle.wait(lock, [this]() { return queue.empty() && busy == 0; });
+}
+
+void ChunkVerifier::loop() {
+    // Cada thread tem o seu descritor: a saída pode ainda não existir quando
+    // o verificador é criado, então abre no primeiro bloco
+    int fd = -1;
+    std::vector<char> buffer(tree.leafSize);
+
+    std::unique_lock<std::mutex> lock(mtx);
+    while (true) {
+        wake.wait(lock, [this]() { return stopping || !queue.empty(); });
+        if (queue.empty()) break;
+
+        uint64_t block = queue.front();
+        queue.pop_front();
+        busy++;
+        lock.unlock();
+
+        if (fd < 0) fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        bool ok = fd >= 0 && verify(fd, block, buffer);
+        onResult(block, ok);
+
+        lock.lock();
+        busy--;
+        if (queue.empty() && busy == 0) idle.notify_all();
+    }
+    lock.unlock();
+
+    if (fd >= 0) ::close(fd);
+}
+
+bool ChunkVerifier::verify(int fd, uint64_t block, std::vector<char>& buffer) const {
+    if (block >= tree.leaves.size()) return false;
+
+    uint64_t offset = block * tree.leafSize;
+    size_t length = static_cast<size_t>(std::min<uint64_t>(tree.leafSize, tree.fileSize - offset));
+    size_t done = 0;
+    while (done < length) {
+        ssize_t n = ::pread(fd, buffer.data() + done, length - done, static_cast<off_t>(offset + done));
+        if (n <= 0) return false;
+        done += static_cast<size_t>(n);
+    }
+    return MerkleTree::hashLeaf({buffer.data(), length}) == tree.leaves[block];
+}
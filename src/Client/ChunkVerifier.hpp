@@ -0,0 +1,53 @@
+#pragma once
+
+#include "../Protocol/MerkleTree.hpp"
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+constexpr size_t CHROMA_VERIFY_THREADS = 4;
+
+// Confere blocos da saída contra as folhas da árvore de Merkle num pool de
+// threads, enquanto o download continua. Cada bloco é lido de volta do
+// arquivo (ainda no page cache, acabou de ser gravado) e hasheado fora da
+// thread de recepção e dos writers; o resultado sai por `onResult`, chamado
+// na thread do pool.
+class ChunkVerifier {
+public:
+    using ResultCallback = std::function<void(uint64_t block, bool ok)>;
+
+    ChunkVerifier(std::string path, MerkleTree tree, ResultCallback onResult,
+                  size_t threads = CHROMA_VERIFY_THREADS);
+    ~ChunkVerifier();
+
+    ChunkVerifier(const ChunkVerifier&) = delete;
+    ChunkVerifier& operator=(const ChunkVerifier&) = delete;
+
+    // Enfileira o bloco `block` (índice de folha), já inteiro no arquivo
+    void submit(uint64_t block);
+
+    // Espera todos os blocos enfileirados serem conferidos
+    void drain();
+
+private:
+    std::string path;
+    MerkleTree tree;
+    ResultCallback onResult;
+
+    std::mutex mtx;
+    std::condition_variable wake;
+    std::condition_variable idle;
+    std::deque<uint64_t> queue;
+    size_t busy{0};
+    bool stopping{false};
+    std::vector<std::thread> workers;
+
+    void loop();
+    bool verify(int fd, uint64_t block, std::vector<char>& buffer) const;
+};
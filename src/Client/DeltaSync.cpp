@@ -0,0 +1,130 @@
+#include "DeltaSync.hpp"
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <unordered_map>
+
+namespace {
+
+constexpr uint64_t NOT_FOUND = UINT64_MAX;
+constexpr unsigned FILTER_BITS = 20;   // filtro de checksums fracos: 1 Mi bits
+
+uint32_t filterSlot(uint32_t weak) {
+    return (weak * 2654435761u) >> (32 - FILTER_BITS);
+}
+
+// copy_file_range evita passar os bytes pelo espaço de usuário; sem suporte
+// (sistemas de arquivos diferentes, kernel antigo) copia com pread/pwrite
+bool copyRange(int from, int to, uint64_t source, uint64_t target, uint64_t length) {
+    auto src = static_cast<off_t>(source);
+    auto dst = static_cast<off_t>(target);
+    while (length > 0) {
+        ssize_t n = ::copy_file_range(from, &src, to, &dst, length, 0);
+        if (n > 0) {
+            length -= static_cast<uint64_t>(n);
+            continue;
+        }
+        if (n < 0 && errno == EINTR) continue;
+        if (n == 0 || (errno != EXDEV && errno != ENOSYS && errno != EINVAL && errno != EOPNOTSUPP)) {
+            return false;
+        }
+
+        std::vector<char> buffer(std::min<uint64_t>(length, 1024 * 1024));
+        while (length > 0) {
+            ssize_t got = ::pread(from, buffer.data(), std::min<uint64_t>(length, buffer.size()), src);
+            if (got <= 0 || ::pwrite(to, buffer.data(), static_cast<size_t>(got), dst) != got) return false;
+            src += got;
+            dst += got;
+            length -= static_cast<uint64_t>(got);
+        }
+    }
+    return true;
+}
+
+}
+
+DeltaSync::DeltaSync(const BlockSignature& signature, std::span<const char> basis) {
+    const size_t blockSize = signature.blockSize;
+    std::vector<uint64_t> found(signature.blocks.size(), NOT_FOUND);
+
+    // Só blocos inteiros são procurados; o último, se for menor, vem do servidor
+    std::unordered_map<uint32_t, std::vector<uint32_t>> byWeak;
+    std::vector<bool> filter(size_t{1} << FILTER_BITS, false);
+    for (size_t i = 0; i < signature.blocks.size(); ++i) {
+        if ((i + 1) * blockSize > signature.fileSize) break;
+        byWeak[signature.blocks[i].weak].push_back(static_cast<uint32_t>(i));
+        filter[filterSlot(signature.blocks[i].weak)] = true;
+    }
+
+    // Janela desliza byte a byte até um bloco bater; depois pula o bloco inteiro
+    size_t pos = 0;
+    RollingChecksum sum;
+    if (basis.size() >= blockSize) sum.reset(basis.subspan(0, blockSize));
+    while (!byWeak.empty() && pos + blockSize <= basis.size()) {
+        bool matched = false;
+        uint32_t weak = sum.value();
+        if (filter[filterSlot(weak)]) {
+            if (auto it = byWeak.find(weak); it != byWeak.end()) {
+                std::span<const char> window = basis.subspan(pos, blockSize);
+                StrongHash strong{};
+                bool hashed = false;
+                for (uint32_t block : it->second) {
+                    if (found[block] != NOT_FOUND) continue;
+                    if (!hashed) {
+                        strong = strongHash(window);
+                        hashed = true;
+                    }
+                    if (signature.blocks[block].strong == strong) {
+                        found[block] = pos;
+                        matched = true;
+                    }
+                }
+            }
+        }
+
+        if (matched) {
+            pos += blockSize;
+            if (pos + blockSize <= basis.size()) sum.reset(basis.subspan(pos, blockSize));
+        } else {
+            if (pos + blockSize < basis.size()) {
+                sum.roll(static_cast<uint8_t>(basis[pos]), static_cast<uint8_t>(basis[pos + blockSize]));
+            }
+            pos++;
+        }
+    }
+
+    // Blocos vizinhos no arquivo novo que também são vizinhos na cópia antiga
+    // viram uma única cópia; os que faltam viram trechos contíguos
+    for (size_t i = 0; i < found.size(); ++i) {
+        uint64_t target = i * blockSize;
+        uint64_t length = std::min<uint64_t>(blockSize, signature.fileSize - target);
+        if (found[i] == NOT_FOUND) {
+            if (!missingRanges.empty() && missingRanges.back().first + missingRanges.back().second == target) {
+                missingRanges.back().second += length;
+            } else {
+                missingRanges.emplace_back(target, length);
+            }
+            continue;
+        }
+        reused += length;
+        if (!copies.empty() && copies.back().target + copies.back().length == target &&
+            copies.back().source + copies.back().length == found[i]) {
+            copies.back().length += length;
+        } else {
+            copies.push_back({target, found[i], length});
+        }
+    }
+}
+
+bool DeltaSync::copyBlocks(int basisFd, int outFd, TransferJournal& journal) const {
+    for (const Copy& copy : copies) {
+        if (!copyRange(basisFd, outFd, copy.source, copy.target, copy.length)) return false;
+    }
+    // Só entra no diário depois que tudo foi copiado: se algo falhar, a saída
+    // é recriada do zero e o diário não pode contar esses bytes
+    for (const Copy& copy : copies) journal.recordWritten(copy.target, copy.length);
+    journal.checkpoint(outFd);
+    return true;
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "../Protocol/BlockSignature.hpp"
+#include "TransferJournal.hpp"
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+// Delta sync no estilo zsync: o servidor manda a assinatura de blocos da
+// versão atual do arquivo e o cliente procura esses blocos, em qualquer
+// offset, na cópia antiga que já tem (checksum fraco deslizante para achar
+// candidatos, SHA-256 para confirmar). Os blocos achados são copiados da
+// cópia antiga; só o resto é pedido ao servidor por GETs de trecho.
+class DeltaSync {
+public:
+    // Bloco do arquivo novo que já existe na cópia antiga
+    struct Copy {
+        uint64_t target;
+        uint64_t source;
+        uint64_t length;
+    };
+
+    // Procura os blocos de `signature` em `basis`
+    DeltaSync(const BlockSignature& signature, std::span<const char> basis);
+
+    // Copia os blocos achados de `basisFd` para `outFd`, registrando no
+    // diário; false se alguma cópia falhou
+    bool copyBlocks(int basisFd, int outFd, TransferJournal& journal) const;
+
+    // Trechos do arquivo novo que não existem na cópia antiga, em ordem
+    [[nodiscard]] const std::vector<TransferJournal::Range>& missing() const { return missingRanges; }
+    [[nodiscard]] uint64_t reusedBytes() const { return reused; }
+
+private:
+    std::vector<Copy> copies;
+    std::vector<TransferJournal::Range> missingRanges;
+    uint64_t reused{0};
+};
@@ -0,0 +1,171 @@
+#include "DiskWriter.hpp"
+
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <stdexcept>
+
+DiskWriter::DiskWriter(const std::string& path, uint64_t fileSize, size_t maxChunk, bool create,
+                       std::shared_ptr<TransferJournal> journal)
+    : fileSize(fileSize),
+      slotSize(std::max<size_t>(maxChunk, 1)),
+      slotCount(std::max(CHROMA_WRITER_BYTES / slotSize, CHROMA_WRITER_MIN_SLOTS)),
+      pool(slotCount * slotSize),
+      filled(slotCount),
+      freeSlots(slotCount),
+      journal(std::move(journal))
+{
+    if (create) preallocate(path, fileSize);
+
+    fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        throw std::runtime_error("Erro ao criar arquivo de saída");
+    }
+
+    for (uint32_t i = 0; i < slotCount; ++i) freeSlots.push(i);
+    worker = std::thread([this]() { loop(); });
+}
+
+DiskWriter::~DiskWriter() {
+    finish();
+}
+
+void DiskWriter::write(uint64_t offset, std::span<const char> data,
+                       const Codec* codec, uint32_t rawLength) {
+    // Cortar o payload gravaria um trecho com buraco e ninguém notaria
+    if (data.size() > slotSize || rawLength > slotSize) {
+        error.store(EMSGSIZE);
+        return;
+    }
+
+    uint32_t slot;
+    while (!freeSlots.pop(slot)) {
+        std::this_thread::yield();   // disco atrasado: segura a recepção
+    }
+
+    std::memcpy(pool.data() + static_cast<size_t>(slot) * slotSize, data.data(), data.size());
+    filled.push({offset, static_cast<uint32_t>(data.size()), slot, codec, rawLength});
+
+    signal.fetch_add(1, std::memory_order_release);
+    signal.notify_one();
+}
+
+void DiskWriter::preallocate(const std::string& path, uint64_t fileSize) {
+    int out = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (out < 0) {
+        throw std::runtime_error("Erro ao criar arquivo de saída");
+    }
+
+    // Reserva os blocos de uma vez; sem suporte do sistema de arquivos,
+    // ao menos fixa o tamanho final
+    if (fileSize > 0 && posix_fallocate(out, 0, static_cast<off_t>(fileSize)) != 0) {
+        if (ftruncate(out, static_cast<off_t>(fileSize)) < 0) {
+            ::close(out);
+            throw std::runtime_error("Erro ao pré-alocar arquivo de saída");
+        }
+    }
+    ::close(out);
+}
+
+bool DiskWriter::finish() {
+    if (worker.joinable()) {
+        running.store(false, std::memory_order_release);
+        signal.fetch_add(1, std::memory_order_release);
+        signal.notify_one();
+        worker.join();
+    }
+    if (fd >= 0) {
+        ::close(fd);
+        fd = -1;
+    }
+    return error.load() == 0;
+}
+
+void DiskWriter::loop() {
+    std::vector<Job> batch;
+    batch.reserve(IOV_MAX);
+
+    while (true) {
+        uint32_t seen = signal.load(std::memory_order_acquire);
+        bool stopping = !running.load(std::memory_order_acquire);
+
+        Job job;
+        while (filled.pop(job)) {
+            if (job.codec) inflate(job);
+            batch.push_back(job);
+            if (batch.size() == IOV_MAX) {
+                flush(batch);
+                batch.clear();
+            }
+        }
+        if (!batch.empty()) {
+            flush(batch);
+            batch.clear();
+        }
+
+        if (journal) journal->maybeCheckpoint(fd);
+        if (stopping) break;
+        signal.wait(seen, std::memory_order_acquire);
+    }
+
+    if (journal) journal->checkpoint(fd);
+}
+
+// Descomprime o slot no lugar, passando por `scratch`; o slot tem o tamanho
+// do chunk, que é o maior payload descomprimido possível
+void DiskWriter::inflate(Job& job) {
+    char* slot = pool.data() + static_cast<size_t>(job.slot) * slotSize;
+    size_t rawLength = job.rawLength;   // write() já recusou o que não cabe no slot
+    scratch.resize(slotSize);
+
+    if (job.codec->decompress({slot, job.length}, {scratch.data(), rawLength})) {
+        std::memcpy(slot, scratch.data(), rawLength);
+    } else {
+        // Sem os bytes certos o trecho não vai para o disco (nem para o diário)
+        error.store(EIO);
+        rawLength = 0;
+    }
+    job.length = static_cast<uint32_t>(rawLength);
+    job.codec = nullptr;
+}
+
+// Pacotes em offsets contíguos (o caso comum) saem num único pwritev
+void DiskWriter::flush(std::span<const Job> jobs) {
+    runs.clear();
+
+    size_t i = 0;
+    while (i < jobs.size()) {
+        Run run{jobs[i].offset, 0, i, 0};
+        while (i < jobs.size() && jobs[i].offset == run.offset + run.length) {
+            iov[i].iov_base = pool.data() + static_cast<size_t>(jobs[i].slot) * slotSize;
+            iov[i].iov_len = jobs[i].length;
+            run.length += jobs[i].length;
+            run.count++;
+            i++;
+        }
+        if (run.offset + run.length <= fileSize) runs.push_back(run);
+    }
+
+    for (const Run& run : runs) {
+        ssize_t written = pwritev(fd, &iov[run.first], static_cast<int>(run.count),
+                                  static_cast<off_t>(run.offset));
+        checkWrite(written < 0 ? -errno : static_cast<int32_t>(written), run);
+    }
+
+    for (const Job& job : jobs) freeSlots.push(job.slot);
+}
+
+void DiskWriter::checkWrite(int32_t result, const Run& run) {
+    if (result < 0) {
+        error.store(-result);
+    } else if (static_cast<uint64_t>(result) != run.length) {
+        error.store(EIO);
+    } else if (journal) {
+        journal->recordWritten(run.offset, run.length);
+    }
+}
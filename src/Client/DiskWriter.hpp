@@ -0,0 +1,94 @@
+#pragma once
+
+#include "../Protocol/Compression.hpp"
+#include "../Protocol/Packet.hpp"
+#include "../Protocol/SpscQueue.hpp"
+#include "TransferJournal.hpp"
+
+#include <sys/uio.h>
+
+#include <array>
+#include <atomic>
+#include <climits>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+constexpr size_t CHROMA_WRITER_BYTES = 4096 * UDP_MAX_PAYLOAD;   // dados aguardando o disco
+constexpr size_t CHROMA_WRITER_MIN_SLOTS = 64;
+
+// Grava o arquivo recebido numa thread própria. O arquivo é pré-alocado com o
+// tamanho do META e cada pacote vai direto para o seu offset com pwrite, então
+// pacotes fora de ordem não precisam ficar na memória até o buraco fechar.
+// A thread de recepção só copia o payload para um buffer do pool e segue;
+// buffers voltam por outra fila SPSC depois de gravados. Com diário, cada
+// trecho gravado é registrado nele e a thread faz os checkpoints periódicos.
+// Payload comprimido (ZDATA) também é descomprimido aqui, fora da recepção.
+class DiskWriter {
+public:
+    // `maxChunk` é o maior payload que chegará (chunk negociado no META).
+    // Com create false o arquivo é aberto como está: vários writers gravam
+    // trechos disjuntos da mesma saída, criada e pré-alocada por um deles.
+    DiskWriter(const std::string& path, uint64_t fileSize, size_t maxChunk = UDP_MAX_PAYLOAD,
+               bool create = true, std::shared_ptr<TransferJournal> journal = nullptr);
+    ~DiskWriter();
+
+    DiskWriter(const DiskWriter&) = delete;
+    DiskWriter& operator=(const DiskWriter&) = delete;
+
+    // Enfileira a gravação; só bloqueia se todos os slots do pool esperam o disco.
+    // Com `codec`, `data` é comprimido e vira `rawLength` bytes (até maxChunk).
+    // Payload maior que maxChunk não é gravado e faz finish() falhar.
+    void write(uint64_t offset, std::span<const char> data,
+               const Codec* codec = nullptr, uint32_t rawLength = 0);
+
+    // Espera tudo ir para o disco e fecha o arquivo; retorna false se houve erro
+    bool finish();
+
+    // Trunca (ou cria) `path` e reserva `fileSize` bytes
+    static void preallocate(const std::string& path, uint64_t fileSize);
+
+private:
+    struct Job {
+        uint64_t offset{0};
+        uint32_t length{0};
+        uint32_t slot{0};
+        const Codec* codec{nullptr};
+        uint32_t rawLength{0};
+    };
+
+    // Trecho contíguo do arquivo: iov[first, first + count)
+    struct Run {
+        uint64_t offset;
+        uint64_t length;
+        size_t first;
+        size_t count;
+    };
+
+    int fd{-1};
+    uint64_t fileSize;
+    size_t slotSize;
+    size_t slotCount;
+    std::vector<char> pool;
+    SpscQueue<Job> filled;         // recepção -> writer
+    SpscQueue<uint32_t> freeSlots; // writer -> recepção
+    std::shared_ptr<TransferJournal> journal;
+
+    std::atomic<uint32_t> signal{0};
+    std::atomic<bool> running{true};
+    std::atomic<int> error{0};
+    std::thread worker;
+
+    // Estado da thread de gravação
+    std::array<iovec, IOV_MAX> iov{};
+    std::vector<Run> runs;
+    std::vector<char> scratch;
+
+    void inflate(Job& job);
+    void loop();
+    void flush(std::span<const Job> jobs);
+    void checkWrite(int32_t result, const Run& run);
+};
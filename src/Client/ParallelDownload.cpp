@@ -0,0 +1,275 @@
+#include "ParallelDownload.hpp"
+#include "ChromaClient.hpp"
+#include "DeltaSync.hpp"
+#include "TransferJournal.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#define GREEN   "\033[32m"
+#define RED     "\033[31m"
+#define YELLOW  "\033[33m"
+#define CYAN    "\033[36m"
+#define RESET   "\033[0m"
+
+ParallelDownload::ParallelDownload(std::string serverIp, int port, int winSize, size_t streams)
+    : serverIp(std::move(serverIp)), port(port), windowSize(winSize), maxStreams(std::max<size_t>(streams, 1)) {}
+
+bool ParallelDownload::fetch(const std::string& filename) {
+    auto start = std::chrono::steady_clock::now();
+
+    // Trecho vazio: o servidor só manda o META (tamanho e versão) e o END.
+    // A saída não é truncada aqui: pode ser um download pela metade.
+    uint64_t fileSize = 0;
+    std::string version;
+    std::string output;
+    std::string merkleRoot;
+    {
+        ChromaClient meta(windowSize);
+        meta.setQuietMode(true);
+        meta.setCompression(compression);
+        meta.connectToServer(serverIp.c_str(), port);
+        meta.setRange(0, 0, false);
+        meta.requestMerkleRoot();
+        meta.sendData(filename.c_str(), filename.size());
+        if (!meta.transferComplete()) {
+            std::cerr << RED << "[ParallelDownload] Não foi possível obter os metadados de "
+                      << filename << RESET << std::endl;
+            return false;
+        }
+        fileSize = static_cast<uint64_t>(meta.getFileSize());
+        version = meta.getFileVersion();
+        output = meta.outputPath();
+        merkleRoot = meta.getMerkleRoot();
+
+        // Servidor sem GET por trecho ignorou o trecho vazio e já mandou o
+        // arquivo inteiro: os trechos pediriam tudo de novo K vezes
+        if (!meta.servesRanges()) {
+            bool ok = ::truncate(output.c_str(), static_cast<off_t>(fileSize)) == 0;
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            std::cout << (ok ? GREEN : RED) << "[ParallelDownload] Servidor sem trechos: " << filename
+                      << (ok ? " completo" : " incompleto") << " em um único GET (" << seconds << " s)"
+                      << RESET << std::endl;
+            return ok;
+        }
+    }
+
+    const std::string basis = output + ".base";
+    struct stat st{};
+    bool haveOldCopy = ::stat(basis.c_str(), &st) == 0 || (::stat(output.c_str(), &st) == 0 && st.st_size > 0);
+
+    auto journal = std::make_shared<TransferJournal>(output, fileSize, version);
+    // Antes de qualquer byte chegar (inclusive os copiados pelo delta sync)
+    bool verified = !merkleRoot.empty() && enableVerification(filename, output, merkleRoot, *journal);
+    if (!verified) {
+        std::cout << YELLOW << "[ParallelDownload] Sem árvore de Merkle: blocos não serão verificados"
+                  << RESET << std::endl;
+    }
+
+    std::vector<TransferJournal::Range> missing;
+    if (journal->resumed()) {
+        missing = journal->missingRanges();
+    } else if (deltaSync && haveOldCopy && !version.empty() && fileSize > 0) {
+        auto delta = syncFromBasis(filename, output, fileSize, version, *journal);
+        if (delta) {
+            missing = std::move(*delta);
+        } else {
+            DiskWriter::preallocate(output, fileSize);
+            missing = journal->missingRanges();
+        }
+    } else {
+        DiskWriter::preallocate(output, fileSize);
+        missing = journal->missingRanges();
+    }
+
+    uint64_t missingBytes = 0;
+    for (const auto& range : missing) missingBytes += range.second;
+    if (journal->resumed()) {
+        std::cout << CYAN << "[ParallelDownload] Retomando " << filename << ": faltam "
+                  << missingBytes << " de " << fileSize << " bytes em " << missing.size()
+                  << " trecho(s)" << RESET << std::endl;
+    }
+
+    // Blocos que não conferem com a árvore são pedidos de novo, algumas vezes
+    bool allPieces = false;
+    for (int round = 0; round < CHROMA_VERIFY_ROUNDS; ++round) {
+        allPieces = downloadRanges(filename, journal, missing);
+        size_t failed = journal->finishVerification();
+        journal->flush();
+        if (failed == 0 || !allPieces) break;
+
+        missing = journal->missingRanges();
+        std::cout << YELLOW << "[ParallelDownload] " << failed << " bloco(s) corrompido(s); pedindo de novo"
+                  << RESET << std::endl;
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    bool ok = allPieces && journal->complete();
+    if (ok) ::unlink(basis.c_str());
+    std::cout << (ok ? GREEN : RED) << "[ParallelDownload] " << filename << (ok ? " completo" : " incompleto")
+              << (ok && verified ? " e verificado" : "") << " em " << seconds << " s ("
+              << (seconds > 0 ? missingBytes / seconds / (1024 * 1024) : 0.0) << " MB/s)"
+              << RESET << std::endl;
+    if (!ok) {
+        std::cout << RED << "[ParallelDownload] Download interrompido; pedir " << filename
+                  << " de novo retoma do ponto em que parou" << RESET << std::endl;
+    }
+    return ok;
+}
+
+bool ParallelDownload::downloadRanges(const std::string& filename, const std::shared_ptr<TransferJournal>& journal,
+                                      const std::vector<TransferJournal::Range>& missing) {
+    uint64_t missingBytes = 0;
+    for (const auto& range : missing) missingBytes += range.second;
+
+    // Os trechos que faltam viram pedaços de até `pieceSize`, alinhados aos
+    // blocos do diário, distribuídos entre os streams conforme terminam
+    size_t streams = static_cast<size_t>(std::clamp<uint64_t>(missingBytes / CHROMA_MIN_RANGE_BYTES, 1, maxStreams));
+    uint64_t pieceSize = (missingBytes + streams - 1) / streams;
+    pieceSize = std::max<uint64_t>((pieceSize + CHROMA_JOURNAL_BLOCK - 1) / CHROMA_JOURNAL_BLOCK, 1) *
+                CHROMA_JOURNAL_BLOCK;
+
+    std::vector<TransferJournal::Range> pieces;
+    for (const auto& [offset, length] : missing) {
+        for (uint64_t done = 0; done < length; done += pieceSize) {
+            pieces.emplace_back(offset + done, std::min(pieceSize, length - done));
+        }
+    }
+    streams = std::max<size_t>(std::min(streams, pieces.size()), pieces.empty() ? 0 : 1);
+    std::cout << CYAN << "[ParallelDownload] " << filename << ": " << missingBytes << " bytes em "
+              << pieces.size() << " trecho(s), " << streams << " stream(s)" << RESET << std::endl;
+
+    std::atomic<size_t> nextPiece{0};
+    std::atomic<size_t> completed{0};
+    std::vector<std::thread> workers;
+    workers.reserve(streams);
+    for (size_t i = 0; i < streams; ++i) {
+        workers.emplace_back([&]() {
+            try {
+                ChromaClient client(windowSize);
+                client.setQuietMode(streams > 1);
+                client.setPacketLossChance(lossChance);
+                client.setJournal(journal);
+                client.setCompression(compression);
+                client.connectToServer(serverIp.c_str(), port);
+
+                for (size_t p = nextPiece++; p < pieces.size(); p = nextPiece++) {
+                    auto [offset, length] = pieces[p];
+                    client.setRange(offset, length, false);
+                    client.sendData(filename.c_str(), filename.size());
+                    if (!client.transferComplete()) {
+                        // Servidor sumiu: o resto fica para a próxima tentativa
+                        std::cerr << RED << "[ParallelDownload] Trecho " << offset << "+" << length
+                                  << " incompleto" << RESET << std::endl;
+                        break;
+                    }
+                    completed++;
+                }
+            } catch (const std::exception& e) {
+                std::cerr << RED << "[ParallelDownload] Stream falhou: " << e.what() << RESET << std::endl;
+            }
+        });
+    }
+    for (std::thread& t : workers) t.join();
+
+    return completed.load() == pieces.size();
+}
+
+std::optional<std::vector<char>> ParallelDownload::fetchAuxiliary(const std::string& filename, const std::string& path,
+                                                                  const std::function<void(ChromaClient&)>& configure) {
+    std::optional<std::vector<char>> bytes;
+    try {
+        ChromaClient client(windowSize);
+        client.setQuietMode(true);
+        client.setCompression(compression);
+        client.connectToServer(serverIp.c_str(), port);
+        configure(client);
+        client.sendData(filename.c_str(), filename.size());
+        if (client.transferComplete()) {
+            std::ifstream in(path, std::ios::binary);
+            bytes.emplace(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        }
+    } catch (const std::exception& e) {
+        std::cerr << YELLOW << "[ParallelDownload] " << e.what() << RESET << std::endl;
+    }
+    ::unlink(path.c_str());
+    return bytes;
+}
+
+bool ParallelDownload::enableVerification(const std::string& filename, const std::string& output,
+                                          const std::string& root, TransferJournal& journal) {
+    const std::string leavesPath = output + ".merkle";
+    auto bytes = fetchAuxiliary(filename, leavesPath, [&](ChromaClient& client) {
+        client.requestMerkleLeaves(leavesPath);
+    });
+    if (!bytes) return false;
+
+    // As folhas só valem se reconstroem a raiz que veio no META
+    std::optional<MerkleTree> tree = MerkleTree::decodeLeaves(*bytes);
+    if (!tree || MerkleTree::toHex(tree->root) != root) {
+        std::cerr << RED << "[ParallelDownload] Folhas da árvore de Merkle não conferem com a raiz"
+                  << RESET << std::endl;
+        return false;
+    }
+    return journal.enableVerification(std::move(*tree));
+}
+
+std::optional<std::vector<TransferJournal::Range>> ParallelDownload::syncFromBasis(
+    const std::string& filename, const std::string& output, uint64_t fileSize,
+    const std::string& version, TransferJournal& journal) {
+    // A cópia antiga sai do caminho da saída; se um delta anterior caiu no
+    // meio, a cópia antiga dele continua sendo a base
+    const std::string basis = output + ".base";
+    if (::access(basis.c_str(), F_OK) != 0 && ::rename(output.c_str(), basis.c_str()) != 0) {
+        return std::nullopt;
+    }
+
+    const std::string signaturePath = output + ".sig";
+    auto bytes = fetchAuxiliary(filename, signaturePath, [&](ChromaClient& client) {
+        client.requestSignature(CHROMA_DELTA_BLOCK, signaturePath);
+    });
+    std::optional<BlockSignature> signature = bytes ? BlockSignature::decode(*bytes) : std::nullopt;
+
+    // A assinatura precisa ser da mesma versão que o META anunciou
+    if (!signature || signature->version != version || signature->fileSize != fileSize) {
+        return std::nullopt;
+    }
+
+    int basisFd = ::open(basis.c_str(), O_RDONLY | O_CLOEXEC);
+    if (basisFd < 0) return std::nullopt;
+    struct stat st{};
+    ::fstat(basisFd, &st);
+    size_t basisSize = static_cast<size_t>(st.st_size);
+    void* mapped = basisSize > 0 ? ::mmap(nullptr, basisSize, PROT_READ, MAP_PRIVATE, basisFd, 0) : nullptr;
+    if (mapped == MAP_FAILED) {
+        ::close(basisFd);
+        return std::nullopt;
+    }
+
+    DeltaSync delta(*signature, {static_cast<const char*>(mapped), basisSize});
+    if (mapped) ::munmap(mapped, basisSize);
+
+    DiskWriter::preallocate(output, fileSize);
+    int outFd = ::open(output.c_str(), O_WRONLY | O_CLOEXEC);
+    bool copied = outFd >= 0 && delta.copyBlocks(basisFd, outFd, journal);
+    if (outFd >= 0) ::close(outFd);
+    ::close(basisFd);
+    if (!copied) return std::nullopt;
+
+    std::cout << CYAN << "[ParallelDownload] Delta sync: " << delta.reusedBytes() << " de " << fileSize
+              << " bytes reaproveitados da cópia antiga (assinatura de " << signature->blocks.size()
+              << " blocos)" << RESET << std::endl;
+    return delta.missing();
+}
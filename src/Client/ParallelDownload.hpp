@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "TransferJournal.hpp"
+
+constexpr size_t CHROMA_MIN_RANGE_BYTES = 4 * 1024 * 1024;   // menor trecho por stream
+constexpr int CHROMA_VERIFY_ROUNDS = 3;   // rodadas para repor blocos que não conferem
+
+class ChromaClient;
+
+// Baixa um arquivo em K trechos simultâneos. Cada trecho é um ChromaClient
+// próprio (socket, janela e thread), então o servidor o atende como sessão
+// independente e, com shards, em outro núcleo. Um GET só de metadados
+// (trecho vazio) descobre o tamanho e a versão do arquivo; depois cada
+// stream grava o seu trecho no offset certo do mesmo arquivo.
+//
+// Todo download tem um TransferJournal: se o anterior caiu no meio e o
+// arquivo no servidor é o mesmo, só os trechos que faltam são pedidos. Sem
+// download pela metade mas com uma cópia antiga da saída, o delta sync
+// (DeltaSync) reaproveita os blocos dela e só pede os que mudaram.
+//
+// Quando o servidor manda a raiz da árvore de Merkle, cada bloco é conferido
+// assim que fica completo (ChunkVerifier) e só os que não batem são pedidos
+// de novo, sem um hash serial do arquivo inteiro no fim.
+class ParallelDownload {
+public:
+    ParallelDownload(std::string serverIp, int port, int winSize, size_t streams);
+
+    void setPacketLossChance(int chance) { lossChance = chance; }
+    void setDeltaSync(bool enabled) { deltaSync = enabled; }
+    void setCompression(bool enabled) { compression = enabled; }
+
+    // true se todos os trechos chegaram inteiros
+    bool fetch(const std::string& filename);
+
+private:
+    std::string serverIp;
+    int port;
+    int windowSize;
+    size_t maxStreams;
+    int lossChance = 0;
+    bool deltaSync = true;
+    bool compression = true;
+
+    // Baixa os trechos com até maxStreams streams; true se todos chegaram
+    bool downloadRanges(const std::string& filename, const std::shared_ptr<TransferJournal>& journal,
+                        const std::vector<TransferJournal::Range>& missing);
+
+    // Baixa um arquivo auxiliar (assinatura, folhas) para `path` e devolve o
+    // conteúdo, apagando o arquivo; nada se o servidor não atendeu
+    std::optional<std::vector<char>> fetchAuxiliary(const std::string& filename, const std::string& path,
+                                                    const std::function<void(ChromaClient&)>& configure);
+
+    // Busca as folhas da árvore, confere com a raiz do META e liga a verificação
+    bool enableVerification(const std::string& filename, const std::string& output,
+                            const std::string& root, TransferJournal& journal);
+
+    // Monta a saída a partir da cópia antiga; devolve o que ainda falta pedir,
+    // ou nada se o delta não deu certo (aí o download é completo)
+    std::optional<std::vector<TransferJournal::Range>> syncFromBasis(
+        const std::string& filename, const std::string& output, uint64_t fileSize,
+        const std::string& version, TransferJournal& journal);
+};
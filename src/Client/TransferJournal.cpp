@@ -0,0 +1,204 @@
+#include "TransferJournal.hpp"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+
+#define RED     "\033[31m"
+#define YELLOW  "\033[33m"
+#define RESET   "\033[0m"
+
+namespace {
+
+constexpr char JOURNAL_MAGIC[8] = {'C', 'H', 'R', 'O', 'M', 'A', 'J', '1'};
+
+}
+
+TransferJournal::TransferJournal(const std::string& outputPath, uint64_t fileSize, const std::string& version)
+    : outputPath(outputPath),
+      path(outputPath + ".journal"),
+      fileSize(fileSize),
+      blockCount((fileSize + CHROMA_JOURNAL_BLOCK - 1) / CHROMA_JOURNAL_BLOCK),
+      durable((blockCount + 7) / 8, 0),
+      writtenBytes(blockCount, 0)
+{
+    Header expected{};
+    std::memcpy(expected.magic, JOURNAL_MAGIC, sizeof(JOURNAL_MAGIC));
+    expected.fileSize = fileSize;
+    expected.blockSize = CHROMA_JOURNAL_BLOCK;
+    std::strncpy(expected.version, version.c_str(), sizeof(expected.version) - 1);
+
+    // Sem versão não dá para saber se o arquivo mudou no servidor: recomeça
+    struct stat st{};
+    bool outputIntact = ::stat(outputPath.c_str(), &st) == 0 && static_cast<uint64_t>(st.st_size) == fileSize;
+    if (!version.empty() && outputIntact) {
+        fd = ::open(path.c_str(), O_RDWR | O_CLOEXEC);
+        Header found{};
+        if (fd >= 0 &&
+            ::pread(fd, &found, sizeof(found), 0) == static_cast<ssize_t>(sizeof(found)) &&
+            std::memcmp(&found, &expected, sizeof(found)) == 0 &&
+            ::pread(fd, durable.data(), durable.size(), sizeof(Header)) == static_cast<ssize_t>(durable.size())) {
+            wasResumed = true;
+            lastCheckpoint.store(nowMs());
+            return;
+        }
+        if (fd >= 0) ::close(fd);
+        std::fill(durable.begin(), durable.end(), 0);
+    }
+
+    fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0 ||
+        ::pwrite(fd, &expected, sizeof(expected), 0) != static_cast<ssize_t>(sizeof(expected)) ||
+        ::pwrite(fd, durable.data(), durable.size(), sizeof(Header)) != static_cast<ssize_t>(durable.size())) {
+        // Sem diário o download funciona igual, só não pode ser retomado
+        std::cerr << YELLOW << "[TransferJournal] Não foi possível criar " << path
+                  << ": " << std::strerror(errno) << RESET << std::endl;
+        if (fd >= 0) ::close(fd);
+        fd = -1;
+    }
+    lastCheckpoint.store(nowMs());
+}
+
+TransferJournal::~TransferJournal() {
+    if (fd >= 0) ::close(fd);
+}
+
+uint64_t TransferJournal::blockLength(uint64_t block) const {
+    return std::min(CHROMA_JOURNAL_BLOCK, fileSize - block * CHROMA_JOURNAL_BLOCK);
+}
+
+std::vector<TransferJournal::Range> TransferJournal::missingRanges() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    std::vector<Range> ranges;
+    for (uint64_t block = 0; block < blockCount; ++block) {
+        if (isDurable(block)) continue;
+        uint64_t offset = block * CHROMA_JOURNAL_BLOCK;
+        if (!ranges.empty() && ranges.back().first + ranges.back().second == offset) {
+            ranges.back().second += blockLength(block);
+        } else {
+            ranges.emplace_back(offset, blockLength(block));
+        }
+    }
+    return ranges;
+}
+
+uint64_t TransferJournal::missingBytes() const {
+    uint64_t total = 0;
+    for (const Range& range : missingRanges()) total += range.second;
+    return total;
+}
+
+void TransferJournal::recordWritten(uint64_t offset, uint64_t length) {
+    uint64_t end = std::min(offset + length, fileSize);
+    if (offset >= end) return;
+
+    std::vector<uint64_t> completed;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        for (uint64_t block = offset / CHROMA_JOURNAL_BLOCK; block * CHROMA_JOURNAL_BLOCK < end; ++block) {
+            uint64_t blockStart = block * CHROMA_JOURNAL_BLOCK;
+            uint64_t overlap = std::min(end, blockStart + blockLength(block)) - std::max(offset, blockStart);
+            uint64_t before = writtenBytes[block];
+            writtenBytes[block] += overlap;
+            if (before < blockLength(block) && writtenBytes[block] >= blockLength(block) && !isDurable(block)) {
+                if (verifier) completed.push_back(block);
+                else pending.push_back(block);
+            }
+        }
+    }
+    for (uint64_t block : completed) verifier->submit(block);
+}
+
+bool TransferJournal::enableVerification(MerkleTree tree) {
+    if (tree.leafSize != CHROMA_JOURNAL_BLOCK || tree.fileSize != fileSize || tree.leaves.size() != blockCount) {
+        return false;
+    }
+    verifier = std::make_unique<ChunkVerifier>(outputPath, std::move(tree),
+        [this](uint64_t block, bool ok) { onVerified(block, ok); });
+    return true;
+}
+
+size_t TransferJournal::finishVerification() {
+    if (verifier) verifier->drain();
+    return failedBlocks.exchange(0);
+}
+
+void TransferJournal::onVerified(uint64_t block, bool ok) {
+    std::lock_guard<std::mutex> lock(mtx);
+    if (ok) {
+        pending.push_back(block);
+        return;
+    }
+    // Conteúdo errado (corrompido fora do alcance do CRC, ou servidor mudou
+    // o arquivo): o bloco volta a faltar e é pedido de novo
+    writtenBytes[block] = 0;
+    failedBlocks++;
+    std::cerr << RED << "[TransferJournal] Bloco " << block << " não confere com a árvore de Merkle"
+              << RESET << std::endl;
+}
+
+void TransferJournal::flush() {
+    int dataFd = ::open(outputPath.c_str(), O_RDONLY | O_CLOEXEC);
+    if (dataFd < 0) return;
+    checkpoint(dataFd);
+    ::close(dataFd);
+}
+
+void TransferJournal::maybeCheckpoint(int dataFd) {
+    if (nowMs() - lastCheckpoint.load(std::memory_order_relaxed) < CHROMA_JOURNAL_INTERVAL_MS) return;
+    checkpoint(dataFd);
+}
+
+void TransferJournal::checkpoint(int dataFd) {
+    std::lock_guard<std::mutex> sync(syncMtx);
+    lastCheckpoint.store(nowMs(), std::memory_order_relaxed);
+
+    std::vector<uint64_t> blocks;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        blocks.swap(pending);
+    }
+    if (blocks.empty()) return;
+
+    // Os blocos pendentes já foram gravados (pwrite retornou), então estão no
+    // page cache; o fdatasync os leva ao disco antes do bitmap dizer que estão lá
+    if (::fdatasync(dataFd) < 0) {
+        std::lock_guard<std::mutex> lock(mtx);
+        pending.insert(pending.end(), blocks.begin(), blocks.end());
+        return;
+    }
+
+    std::vector<uint8_t> snapshot;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        for (uint64_t block : blocks) durable[block / 8] |= static_cast<uint8_t>(1u << (block % 8));
+        snapshot = durable;
+    }
+    if (fd >= 0 && ::pwrite(fd, snapshot.data(), snapshot.size(), sizeof(Header)) < 0) {
+        std::cerr << YELLOW << "[TransferJournal] Falha ao gravar " << path
+                  << ": " << std::strerror(errno) << RESET << std::endl;
+    }
+}
+
+bool TransferJournal::complete() {
+    std::lock_guard<std::mutex> lock(mtx);
+    for (uint64_t block = 0; block < blockCount; ++block) {
+        if (!isDurable(block)) return false;
+    }
+    if (fd >= 0) {
+        ::close(fd);
+        fd = -1;
+    }
+    ::unlink(path.c_str());
+    return true;
+}
+
+int64_t TransferJournal::nowMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
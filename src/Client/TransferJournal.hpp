@@ -0,0 +1,104 @@
+#pragma once
+
+#include "../Protocol/MerkleTree.hpp"
+#include "ChunkVerifier.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+constexpr uint64_t CHROMA_JOURNAL_BLOCK = CHROMA_MERKLE_LEAF;   // bloco do bitmap = folha da árvore
+constexpr int CHROMA_JOURNAL_INTERVAL_MS = 1000;         // intervalo entre checkpoints
+
+// Diário de um download, ao lado da saída (`<saída>.journal`): um bitmap com
+// os blocos de CHROMA_JOURNAL_BLOCK bytes que já estão gravados *e* no disco.
+// Os writers contam os bytes gravados de cada bloco; bloco completo fica
+// pendente até o próximo checkpoint, que faz fdatasync da saída e só então
+// grava o bitmap. Bits só passam de 0 para 1, então um diário meio escrito
+// (queda no meio do pwrite) no máximo esquece blocos, nunca inventa.
+//
+// Depois de uma queda, missingRanges() diz o que ainda falta pedir. O diário
+// só é reaproveitado se o tamanho e a versão do arquivo no servidor batem.
+//
+// Com verificação ligada, bloco completo passa antes pelo ChunkVerifier: só
+// vai para o bitmap se bater com a folha da árvore de Merkle; se não bater,
+// volta a faltar e o próximo missingRanges() o inclui.
+class TransferJournal {
+public:
+    using Range = std::pair<uint64_t, uint64_t>;   // offset, tamanho
+
+    // Abre o diário existente de `outputPath` ou começa um novo (e então a
+    // saída precisa ser recriada: veja resumed())
+    TransferJournal(const std::string& outputPath, uint64_t fileSize, const std::string& version);
+    ~TransferJournal();
+
+    TransferJournal(const TransferJournal&) = delete;
+    TransferJournal& operator=(const TransferJournal&) = delete;
+
+    // true se o diário anterior valia para este arquivo e a saída ainda existe
+    [[nodiscard]] bool resumed() const { return wasResumed; }
+
+    // Trechos ainda não gravados, alinhados a blocos e em ordem
+    [[nodiscard]] std::vector<Range> missingRanges() const;
+    [[nodiscard]] uint64_t missingBytes() const;
+
+    // Confere cada bloco completo contra `tree` (já validada contra a raiz do
+    // META); false se a árvore não corresponde a este arquivo
+    bool enableVerification(MerkleTree tree);
+
+    // Espera as verificações em andamento; retorna quantos blocos falharam
+    // desde a chamada anterior
+    size_t finishVerification();
+
+    // Chamado pelos writers depois que [offset, offset + length) foi gravado
+    void recordWritten(uint64_t offset, uint64_t length);
+
+    // fdatasync da saída e gravação do bitmap; maybeCheckpoint só age se o
+    // último checkpoint tem mais de CHROMA_JOURNAL_INTERVAL_MS
+    void checkpoint(int dataFd);
+    void maybeCheckpoint(int dataFd);
+
+    // Checkpoint sem writer aberto (depois das verificações finais)
+    void flush();
+
+    // Download completo: apaga o diário. false se ainda falta algum bloco.
+    bool complete();
+
+private:
+    struct Header {
+        char magic[8];
+        uint64_t fileSize;
+        uint64_t blockSize;
+        char version[64];
+    };
+
+    std::string outputPath;
+    std::string path;
+    uint64_t fileSize;
+    uint64_t blockCount;
+    int fd{-1};
+    bool wasResumed{false};
+
+    mutable std::mutex mtx;
+    std::vector<uint8_t> durable;          // bitmap persistido
+    std::vector<uint64_t> writtenBytes;    // por bloco, nesta execução
+    std::vector<uint64_t> pending;         // blocos completos esperando fdatasync
+
+    std::mutex syncMtx;                    // um checkpoint por vez
+    std::atomic<int64_t> lastCheckpoint{0};
+
+    std::atomic<size_t> failedBlocks{0};
+    std::unique_ptr<ChunkVerifier> verifier;   // último: para antes do resto ser destruído
+
+    [[nodiscard]] uint64_t blockLength(uint64_t block) const;
+    void onVerified(uint64_t block, bool ok);
+    [[nodiscard]] bool isDurable(uint64_t block) const {
+        return (durable[block / 8] >> (block % 8)) & 1;
+    }
+    static int64_t nowMs();
+};
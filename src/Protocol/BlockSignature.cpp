@@ -0,0 +1,90 @@
+#include "BlockSignature.hpp"
+
+#include <arpa/inet.h>
+#include <openssl/evp.h>
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+void RollingChecksum::reset(std::span<const char> window) {
+    a = 0;
+    b = 0;
+    windowSize = static_cast<uint32_t>(window.size());
+    for (size_t i = 0; i < window.size(); ++i) {
+        auto x = static_cast<uint8_t>(window[i]);
+        a = static_cast<uint16_t>(a + x);
+        b = static_cast<uint16_t>(b + (window.size() - i) * x);
+    }
+}
+
+uint32_t RollingChecksum::compute(std::span<const char> window) {
+    RollingChecksum sum;
+    sum.reset(window);
+    return sum.value();
+}
+
+StrongHash strongHash(std::span<const char> block) {
+    unsigned char digest[EVP_MAX_MD_SIZE];
+    unsigned int length = 0;
+    if (EVP_Digest(block.data(), block.size(), digest, &length, EVP_sha256(), nullptr) != 1) {
+        throw std::runtime_error("Falha ao calcular SHA-256");
+    }
+    StrongHash hash{};
+    std::memcpy(hash.data(), digest, hash.size());
+    return hash;
+}
+
+std::vector<char> BlockSignature::encode(std::span<const char> file, uint32_t blockSize, const std::string& version) {
+    std::vector<char> out;
+    auto appendStr = [&](const std::string& s) {
+        out.insert(out.end(), s.begin(), s.end());
+        out.push_back('\0');
+    };
+    appendStr(std::to_string(blockSize));
+    appendStr(std::to_string(file.size()));
+    appendStr(version);
+
+    size_t blocks = (file.size() + blockSize - 1) / blockSize;
+    out.reserve(out.size() + blocks * (sizeof(uint32_t) + CHROMA_STRONG_HASH_SIZE));
+    for (size_t offset = 0; offset < file.size(); offset += blockSize) {
+        std::span<const char> block = file.subspan(offset, std::min<size_t>(blockSize, file.size() - offset));
+        uint32_t weak = htonl(RollingChecksum::compute(block));
+        StrongHash strong = strongHash(block);
+        out.insert(out.end(), reinterpret_cast<const char*>(&weak), reinterpret_cast<const char*>(&weak) + sizeof(weak));
+        out.insert(out.end(), strong.begin(), strong.end());
+    }
+    return out;
+}
+
+std::optional<BlockSignature> BlockSignature::decode(std::span<const char> bytes) {
+    BlockSignature sig;
+    size_t pos = 0;
+    auto readStr = [&](std::string& s) {
+        const char* end = static_cast<const char*>(std::memchr(bytes.data() + pos, '\0', bytes.size() - pos));
+        if (!end) return false;
+        s.assign(bytes.data() + pos, end);
+        pos = static_cast<size_t>(end - bytes.data()) + 1;
+        return true;
+    };
+
+    std::string blockStr, sizeStr;
+    if (!readStr(blockStr) || !readStr(sizeStr) || !readStr(sig.version)) return std::nullopt;
+    sig.blockSize = static_cast<uint32_t>(std::strtoul(blockStr.c_str(), nullptr, 10));
+    sig.fileSize = std::strtoull(sizeStr.c_str(), nullptr, 10);
+    if (sig.blockSize < CHROMA_DELTA_MIN_BLOCK || sig.blockSize > CHROMA_DELTA_MAX_BLOCK) return std::nullopt;
+
+    constexpr size_t entry = sizeof(uint32_t) + CHROMA_STRONG_HASH_SIZE;
+    uint64_t count = (sig.fileSize + sig.blockSize - 1) / sig.blockSize;
+    if (bytes.size() - pos != count * entry) return std::nullopt;
+
+    sig.blocks.resize(count);
+    for (Block& block : sig.blocks) {
+        uint32_t weak;
+        std::memcpy(&weak, bytes.data() + pos, sizeof(weak));
+        block.weak = ntohl(weak);
+        std::memcpy(block.strong.data(), bytes.data() + pos + sizeof(weak), CHROMA_STRONG_HASH_SIZE);
+        pos += entry;
+    }
+    return sig;
+}
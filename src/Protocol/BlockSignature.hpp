@@ -0,0 +1,61 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+constexpr uint32_t CHROMA_DELTA_BLOCK = 16 * 1024;        // bloco padrão do delta sync
+constexpr uint32_t CHROMA_DELTA_MIN_BLOCK = 1024;
+constexpr uint32_t CHROMA_DELTA_MAX_BLOCK = 1024 * 1024;
+constexpr size_t CHROMA_STRONG_HASH_SIZE = 16;            // SHA-256 truncado
+
+// Checksum fraco do rsync: a = soma dos bytes, b = soma ponderada pela posição
+// (ambos mod 2^16). Desliza de um byte em O(1), o que permite procurar blocos
+// conhecidos em qualquer offset do arquivo.
+class RollingChecksum {
+public:
+    void reset(std::span<const char> window);
+
+    // Tira `out` do começo da janela e põe `in` no fim
+    void roll(uint8_t out, uint8_t in) {
+        a = static_cast<uint16_t>(a - out + in);
+        b = static_cast<uint16_t>(b - windowSize * out + a);
+    }
+
+    [[nodiscard]] uint32_t value() const { return static_cast<uint32_t>(b) << 16 | a; }
+
+    static uint32_t compute(std::span<const char> window);
+
+private:
+    uint16_t a{0};
+    uint16_t b{0};
+    uint32_t windowSize{0};
+};
+
+using StrongHash = std::array<uint8_t, CHROMA_STRONG_HASH_SIZE>;
+
+// SHA-256 (OpenSSL) truncado: confirma um bloco que o checksum fraco apontou
+StrongHash strongHash(std::span<const char> block);
+
+// Assinatura de um arquivo, bloco a bloco. O último bloco pode ser menor.
+//
+// Formato: "<blockSize>\0<fileSize>\0<versão>\0" seguido, para cada bloco,
+// do checksum fraco (4 bytes, ordem de rede) e do hash forte.
+struct BlockSignature {
+    struct Block {
+        uint32_t weak;
+        StrongHash strong;
+    };
+
+    uint32_t blockSize{CHROMA_DELTA_BLOCK};
+    uint64_t fileSize{0};
+    std::string version;
+    std::vector<Block> blocks;
+
+    static std::vector<char> encode(std::span<const char> file, uint32_t blockSize, const std::string& version);
+    static std::optional<BlockSignature> decode(std::span<const char> bytes);
+};
@@ -1,5 +1,6 @@
 #include "ChromaProtocol.hpp"
 
+#include <algorithm>
 #include <cerrno>
 #include <cstring>
 #include <iostream>
@@ -7,11 +8,13 @@
 #include <vector>
 
 ChromaProtocol::ChromaProtocol(int winSize)
-    : windowSize(winSize), bufferSize(BUFFER_SIZE), base(0), nextSeqNum(0)
+    : base(0), nextSeqNum(0)
 {
-    if(winSize <= 0 || winSize > BUFFER_SIZE/2 - 1) {
+    if(winSize <= 0 || winSize > MAX_WIDE_WINDOW_SIZE) {
         throw std::invalid_argument("Tamanho da janela inválido");
     }
+    maxWindowSize = static_cast<uint32_t>(winSize);
+    setWireVersion(CHROMA_VERSION_LEGACY, maxWindowSize);
    
     sockfd = ::socket(AF_INET, SOCK_DGRAM, 0);
     if (sockfd < 0) {
@@ -19,6 +22,41 @@ ChromaProtocol::ChromaProtocol(int winSize)
     }
     std::cout << "[ChromaProtocol] Socket criado com sucesso (fd=" << sockfd << ")\n";
     std::memset(&addr, 0, sizeof(addr));
+
+    // Kernel sem UDP_SEGMENT recusa a opção; aí cada datagrama sai sozinho
+    int noSegment = 0;
+    gsoEnabled = ::setsockopt(sockfd, IPPROTO_UDP, UDP_SEGMENT, &noSegment, sizeof(noSegment)) == 0;
+
+    recvBatchBuffer.resize(CHROMA_BATCH_SIZE * UDP_MAX_PAYLOAD);
+    for (size_t i = 0; i < CHROMA_BATCH_SIZE; ++i) {
+        recvIov[i].iov_base = recvBatchBuffer.data() + i * UDP_MAX_PAYLOAD;
+        recvIov[i].iov_len = UDP_MAX_PAYLOAD;
+    }
+}
+
+bool ChromaProtocol::enableReceiveOffload() {
+    // Menos buffers, mas cada um comporta um datagrama de até 64 KiB
+    recvSlotSize = 65535;
+    recvSlots = CHROMA_GRO_SLOTS;
+    recvBatchBuffer.assign(recvSlots * recvSlotSize, 0);
+    for (size_t i = 0; i < recvSlots; ++i) {
+        recvIov[i].iov_base = recvBatchBuffer.data() + i * recvSlotSize;
+        recvIov[i].iov_len = recvSlotSize;
+    }
+    recvFilled = recvCursor = 0;
+    recvOffset = 0;
+
+    growSocketBuffer(SO_RCVBUF, SO_RCVBUFFORCE, CHROMA_BULK_SOCKET_BUFFER);
+
+    int on = 1;
+    groEnabled = ::setsockopt(sockfd, IPPROTO_UDP, UDP_GRO, &on, sizeof(on)) == 0;
+    return groEnabled;
+}
+
+void ChromaProtocol::growSocketBuffer(int option, int forceOption, int bytes) {
+    if (::setsockopt(sockfd, SOL_SOCKET, forceOption, &bytes, sizeof(bytes)) < 0) {
+        ::setsockopt(sockfd, SOL_SOCKET, option, &bytes, sizeof(bytes));
+    }
 }
 
 ChromaProtocol::~ChromaProtocol() {
@@ -28,39 +66,288 @@ ChromaProtocol::~ChromaProtocol() {
     }
 }
 
-ssize_t ChromaProtocol::sendPacket(const Packet& pkt, const sockaddr_in& dest) {
-    auto buffer = pkt.serialize();
-    ssize_t sent = ::sendto(sockfd, buffer.data(), buffer.size(), 0,
-                            reinterpret_cast<const sockaddr*>(&dest), sizeof(dest));
+void ChromaProtocol::setWireVersion(uint8_t version, uint32_t window) {
+    window = std::clamp<uint32_t>(window, 1, maxWindowSize);
+
+    if (version == CHROMA_VERSION_WIDE) {
+        wireVersion = CHROMA_VERSION_WIDE;
+        seqMask = 0xFFFFFFFFU;
+        windowSize = window;
+    } else {
+        wireVersion = CHROMA_VERSION_LEGACY;
+        seqMask = BUFFER_SIZE - 1;
+        windowSize = std::min<uint32_t>(window, WINDOW_SIZE);
+    }
+}
+
+ChromaProtocol::Options ChromaProtocol::parseOptions(std::span<const char> data, size_t positionalFields) {
+    Options options;
+    size_t field = 0;
+    size_t start = 0;
+
+    for (size_t i = 0; i <= data.size(); ++i) {
+        if (i < data.size() && data[i] != '\0') continue;
+
+        if (field++ >= positionalFields && i > start) {
+            std::string token(data.data() + start, i - start);
+            size_t eq = token.find('=');
+            if (eq != std::string::npos) {
+                options[token.substr(0, eq)] = token.substr(eq + 1);
+            }
+        }
+        start = i + 1;
+    }
+    return options;
+}
+
+void ChromaProtocol::appendOption(std::vector<char>& out, const std::string& key, const std::string& value) {
+    out.insert(out.end(), key.begin(), key.end());
+    out.push_back('=');
+    out.insert(out.end(), value.begin(), value.end());
+    out.push_back('\0');
+}
+
+ssize_t ChromaProtocol::sendRaw(uint32_t seq, ChromaFlag flag, uint32_t checksum,
+                                std::span<const char> payload, const sockaddr_in& dest) {
+    // Cabeçalho na pilha + payload por referência: sendmsg junta os dois (scatter-gather)
+    std::array<char, CHROMA_MAX_HEADER_SIZE> header;
+    size_t headerLen = Packet::encodeHeader(header.data(), wireVersion, seq, flag,
+                                            static_cast<uint32_t>(payload.size()), checksum);
+
+    iovec iov[2];
+    iov[0].iov_base = header.data();
+    iov[0].iov_len = headerLen;
+    iov[1].iov_base = const_cast<char*>(payload.data());
+    iov[1].iov_len = payload.size();
+
+    msghdr msg{};
+    msg.msg_name = const_cast<sockaddr_in*>(&dest);
+    msg.msg_namelen = sizeof(dest);
+    msg.msg_iov = iov;
+    msg.msg_iovlen = payload.empty() ? 1 : 2;
+
+    ssize_t sent = ::sendmsg(sockfd, &msg, 0);
     if (sent < 0) {
-        std::cerr << "[ChromaProtocol] Erro em sendto(): " << std::strerror(errno) << "\n";
+        std::cerr << "[ChromaProtocol] Erro em sendmsg(): " << std::strerror(errno) << "\n";
     }
     return sent;
 }
 
+ssize_t ChromaProtocol::sendPacket(const Packet& pkt, const sockaddr_in& dest) {
+    return sendRaw(pkt.seqNum, pkt.flag, pkt.checksum, pkt.data, dest);
+}
+
+ssize_t ChromaProtocol::sendPacket(uint32_t seq, ChromaFlag flag, std::span<const char> payload,
+                                   const sockaddr_in& dest) {
+    return sendRaw(seq, flag, Packet::computeChecksum(payload), payload, dest);
+}
+
+ssize_t ChromaProtocol::recvPacket(PacketView& view) {
+    if (!hasPendingReceive()) {
+        int received = fillReceiveSlots(1, 0);
+        if (received <= 0) {
+            return received;
+        }
+    }
+    return drainReceived({&view, 1}) == 1 ? static_cast<ssize_t>(recvLastSize) : -1;
+}
+
 ssize_t ChromaProtocol::recvPacket(Packet& pkt) {
-    std::vector<char> buffer(UDP_MAX_PAYLOAD);
-    socklen_t addrLen = sizeof(pkt.srcAddr);
-    ssize_t received = ::recvfrom(sockfd, buffer.data(), buffer.size(), 0,
-                                  reinterpret_cast<sockaddr*>(&pkt.srcAddr), &addrLen);
-    if (received <= 0) {
+    PacketView view;
+    ssize_t received = recvPacket(view);
+    if (received > 0) {
+        pkt = Packet(view);
+    }
+    return received;
+}
+
+int ChromaProtocol::sendBatch(std::span<const OutgoingPacket> pkts, const sockaddr_in& dest) {
+    size_t total = 0;
+
+    while (total < pkts.size()) {
+        size_t count = std::min(pkts.size() - total, CHROMA_BATCH_SIZE);
+        size_t messages = prepareMessages(pkts.subspan(total, count), dest);
+
+        int sent = ::sendmmsg(sockfd, sendMsgs.data(), static_cast<unsigned>(messages), 0);
+        if (sent < 0) {
+            if (errno == EINTR) continue;
+            // Placa ou caminho sem suporte a GSO: desliga e reenvia pacote a
+            // pacote. O sendmmsg só falha inteiro quando a primeira mensagem
+            // falha, então o erro é dela; se ela não era segmentada, o GSO
+            // não tem culpa e o erro segue como qualquer outro.
+            bool segmented = sendMsgPackets[0] > 1;
+            if (segmented && (errno == EIO || errno == EINVAL || errno == EOPNOTSUPP || errno == EMSGSIZE)) {
+                std::cerr << "[ChromaProtocol] GSO recusado (" << std::strerror(errno)
+                          << "), enviando datagramas separados\n";
+                gsoEnabled = false;
+                continue;
+            }
+            std::cerr << "[ChromaProtocol] Erro em sendmmsg(): " << std::strerror(errno) << "\n";
+            break;
+        }
+        for (int m = 0; m < sent; ++m) {
+            total += sendMsgPackets[m];
+        }
+    }
+
+    return (total == 0 && !pkts.empty()) ? -1 : static_cast<int>(total);
+}
+
+size_t ChromaProtocol::prepareMessages(std::span<const OutgoingPacket> pkts, const sockaddr_in& dest) {
+    size_t headerLen = 0;
+    for (size_t i = 0; i < pkts.size(); ++i) {
+        const OutgoingPacket& pkt = pkts[i];
+        headerLen = Packet::encodeHeader(sendHeaders[i].data(), wireVersion, pkt.seqNum, pkt.flag,
+                                         static_cast<uint32_t>(pkt.data.size()), pkt.checksum);
+
+        iovec* iov = &sendIov[2 * i];
+        iov[0].iov_base = sendHeaders[i].data();
+        iov[0].iov_len = headerLen;
+        iov[1].iov_base = const_cast<char*>(pkt.data.data());
+        iov[1].iov_len = pkt.data.size();
+    }
+
+    size_t messages = 0;
+    size_t i = 0;
+    while (i < pkts.size()) {
+        // Segmentos GSO têm todos o mesmo tamanho; só o último pode ser menor
+        size_t segment = headerLen + pkts[i].data.size();
+        size_t k = 1;
+        if (gsoEnabled) {
+            size_t maxSegments = std::min(CHROMA_GSO_MAX_SEGMENTS, CHROMA_OFFLOAD_MAX_BYTES / segment);
+            while (i + k < pkts.size() && k < maxSegments) {
+                size_t next = headerLen + pkts[i + k].data.size();
+                if (next > segment) break;
+                k++;
+                if (next < segment) break;
+            }
+        }
+
+        msghdr& msg = sendMsgs[messages].msg_hdr;
+        msg = {};
+        msg.msg_name = const_cast<sockaddr_in*>(&dest);
+        msg.msg_namelen = sizeof(dest);
+        msg.msg_iov = &sendIov[2 * i];
+        msg.msg_iovlen = 2 * k;
+
+        if (k > 1) {
+            msg.msg_control = sendControl[messages].data();
+            msg.msg_controllen = sendControl[messages].size();
+            cmsghdr* cm = CMSG_FIRSTHDR(&msg);
+            cm->cmsg_level = IPPROTO_UDP;
+            cm->cmsg_type = UDP_SEGMENT;
+            cm->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+            auto gsoSize = static_cast<uint16_t>(segment);
+            std::memcpy(CMSG_DATA(cm), &gsoSize, sizeof(gsoSize));
+        }
+
+        sendMsgPackets[messages++] = k;
+        i += k;
+    }
+    return messages;
+}
+
+int ChromaProtocol::recvBatch(std::span<PacketView> views) {
+    if (!hasPendingReceive()) {
+        int received = fillReceiveSlots(views.size(), MSG_DONTWAIT);
+        if (received <= 0) {
+            return received;
+        }
+    }
+    return static_cast<int>(drainReceived(views));
+}
+
+int ChromaProtocol::fillReceiveSlots(size_t count, int flags) {
+    count = std::min(count, recvSlots);
+
+    for (size_t i = 0; i < count; ++i) {
+        msghdr& msg = recvMsgs[i].msg_hdr;
+        msg = {};
+        msg.msg_name = &recvAddrs[i];
+        msg.msg_namelen = sizeof(sockaddr_in);
+        msg.msg_iov = &recvIov[i];
+        msg.msg_iovlen = 1;
+        if (groEnabled) {
+            msg.msg_control = recvControl[i].data();
+            msg.msg_controllen = recvControl[i].size();
+        }
+    }
+
+    int received = ::recvmmsg(sockfd, recvMsgs.data(), static_cast<unsigned>(count), flags, nullptr);
+    if (received < 0) {
+        if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+            std::cerr << "[ChromaProtocol] Erro em recvmmsg(): " << std::strerror(errno) << "\n";
+        }
         return received;
     }
-    try {
-        pkt.deserialize({buffer.begin(), buffer.begin() + received}, pkt.srcAddr);
-    } catch (const std::runtime_error& e) {
-        std::cerr << "[ChromaProtocol] Falha ao desserializar pacote: " << e.what()
-                  << " (bytes recebidos=" << received << ")\n";
-        return -1;
+
+    for (int i = 0; i < received; ++i) {
+        recvSegment[i] = recvMsgs[i].msg_len;
+        if (!groEnabled) continue;
+
+        msghdr& msg = recvMsgs[i].msg_hdr;
+        for (cmsghdr* cm = CMSG_FIRSTHDR(&msg); cm; cm = CMSG_NXTHDR(&msg, cm)) {
+            if (cm->cmsg_level == IPPROTO_UDP && cm->cmsg_type == UDP_GRO) {
+                int gsoSize;
+                std::memcpy(&gsoSize, CMSG_DATA(cm), sizeof(gsoSize));
+                if (gsoSize > 0) recvSegment[i] = static_cast<size_t>(gsoSize);
+            }
+        }
     }
+
+    recvFilled = received;
+    recvCursor = 0;
+    recvOffset = 0;
     return received;
 }
 
+// Separa os buffers recebidos em pacotes, descartando datagramas malformados
+size_t ChromaProtocol::drainReceived(std::span<PacketView> views) {
+    size_t produced = 0;
+
+    while (produced < views.size() && recvCursor < recvFilled) {
+        int i = recvCursor;
+        size_t total = recvMsgs[i].msg_len;
+
+        if (recvOffset == 0 && (recvMsgs[i].msg_hdr.msg_flags & MSG_TRUNC)) {
+            std::cerr << "[ChromaProtocol] Datagrama truncado descartado\n";
+            recvCursor++;
+            continue;
+        }
+
+        size_t length = std::min(recvSegment[i], total - recvOffset);
+        std::span<const char> buffer(static_cast<const char*>(recvIov[i].iov_base) + recvOffset, length);
+        recvOffset += length;
+        if (recvOffset >= total) {
+            recvCursor++;
+            recvOffset = 0;
+        }
+
+        PacketView& view = views[produced];
+        if (!Packet::parse(buffer, wireVersion, view)) {
+            std::cerr << "[ChromaProtocol] Falha ao desserializar pacote"
+                      << " (bytes recebidos=" << length << ")\n";
+            continue;
+        }
+        view.srcAddr = recvAddrs[i];
+        recvLastSize = length;
+        produced++;
+    }
+    return produced;
+}
+
 bool ChromaProtocol::waitResponse(int timeoutSec) {
+    return waitResponseMs(timeoutSec * 1000);
+}
+
+bool ChromaProtocol::waitResponseMs(int timeoutMs) {
+    if (hasPendingReceive()) {
+        return true;   // sobrou datagrama de um buffer GRO já recebido
+    }
     fd_set fds;
     FD_ZERO(&fds);
     FD_SET(sockfd, &fds);
-    timeval tv{timeoutSec, 0};
+    timeval tv{timeoutMs / 1000, (timeoutMs % 1000) * 1000};
     int ret = ::select(sockfd + 1, &fds, nullptr, nullptr, &tv);
     if (ret < 0) {
         throw std::runtime_error("Erro em select(): " + std::string(std::strerror(errno)));
@@ -0,0 +1,180 @@
+#include "Compression.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#if defined(CHROMA_HAVE_ZLIB)
+#include <zlib.h>
+#endif
+#if defined(CHROMA_HAVE_ZSTD)
+#include <zstd.h>
+#endif
+#if defined(CHROMA_HAVE_LZ4)
+#include <lz4.h>
+#endif
+
+namespace {
+
+#if defined(CHROMA_HAVE_ZSTD)
+class ZstdCodec final : public Codec {
+public:
+    const char* name() const override { return "zstd"; }
+
+    size_t compress(std::span<const char> in, std::span<char> out) const override {
+        thread_local std::unique_ptr<ZSTD_CCtx, decltype(&ZSTD_freeCCtx)> ctx{ZSTD_createCCtx(), ZSTD_freeCCtx};
+        size_t n = ZSTD_compressCCtx(ctx.get(), out.data(), out.size(), in.data(), in.size(), 1);
+        return ZSTD_isError(n) ? 0 : n;
+    }
+
+    bool decompress(std::span<const char> in, std::span<char> out) const override {
+        thread_local std::unique_ptr<ZSTD_DCtx, decltype(&ZSTD_freeDCtx)> ctx{ZSTD_createDCtx(), ZSTD_freeDCtx};
+        size_t n = ZSTD_decompressDCtx(ctx.get(), out.data(), out.size(), in.data(), in.size());
+        return !ZSTD_isError(n) && n == out.size();
+    }
+};
+#endif
+
+#if defined(CHROMA_HAVE_LZ4)
+class Lz4Codec final : public Codec {
+public:
+    const char* name() const override { return "lz4"; }
+
+    size_t compress(std::span<const char> in, std::span<char> out) const override {
+        int n = LZ4_compress_default(in.data(), out.data(), static_cast<int>(in.size()), static_cast<int>(out.size()));
+        return n > 0 ? static_cast<size_t>(n) : 0;
+    }
+
+    bool decompress(std::span<const char> in, std::span<char> out) const override {
+        int n = LZ4_decompress_safe(in.data(), out.data(), static_cast<int>(in.size()), static_cast<int>(out.size()));
+        return n >= 0 && static_cast<size_t>(n) == out.size();
+    }
+};
+#endif
+
+#if defined(CHROMA_HAVE_ZLIB)
+// Deflate cru (sem cabeçalho zlib: o checksum do pacote já cobre o payload),
+// nível 1. Os z_stream ficam por thread e só são reiniciados entre chunks,
+// sem alocar o estado do deflate a cada pacote.
+class ZlibCodec final : public Codec {
+public:
+    const char* name() const override { return "zlib"; }
+
+    size_t compress(std::span<const char> in, std::span<char> out) const override {
+        thread_local Stream stream(true);
+        if (!stream.ready) return 0;
+        z_stream& z = stream.z;
+        deflateReset(&z);
+        z.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(in.data()));
+        z.avail_in = static_cast<uInt>(in.size());
+        z.next_out = reinterpret_cast<Bytef*>(out.data());
+        z.avail_out = static_cast<uInt>(out.size());
+        if (deflate(&z, Z_FINISH) != Z_STREAM_END) return 0;
+        return out.size() - z.avail_out;
+    }
+
+    bool decompress(std::span<const char> in, std::span<char> out) const override {
+        thread_local Stream stream(false);
+        if (!stream.ready) return false;
+        z_stream& z = stream.z;
+        inflateReset(&z);
+        z.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(in.data()));
+        z.avail_in = static_cast<uInt>(in.size());
+        z.next_out = reinterpret_cast<Bytef*>(out.data());
+        z.avail_out = static_cast<uInt>(out.size());
+        return inflate(&z, Z_FINISH) == Z_STREAM_END && z.avail_out == 0;
+    }
+
+private:
+    struct Stream {
+        z_stream z{};
+        bool deflating;
+        bool ready;
+
+        explicit Stream(bool deflating) : deflating(deflating) {
+            ready = deflating
+                ? deflateInit2(&z, 1, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) == Z_OK
+                : inflateInit2(&z, -MAX_WBITS) == Z_OK;
+        }
+        ~Stream() {
+            if (!ready) return;
+            if (deflating) deflateEnd(&z);
+            else inflateEnd(&z);
+        }
+    };
+};
+#endif
+
+// Ordem de preferência: mais rápido e melhor razão primeiro
+const std::vector<const Codec*>& codecs() {
+    static const std::vector<const Codec*> all = [] {
+        std::vector<const Codec*> list;
+#if defined(CHROMA_HAVE_ZSTD)
+        static ZstdCodec zstd;
+        list.push_back(&zstd);
+#endif
+#if defined(CHROMA_HAVE_LZ4)
+        static Lz4Codec lz4;
+        list.push_back(&lz4);
+#endif
+#if defined(CHROMA_HAVE_ZLIB)
+        static ZlibCodec zlib;
+        list.push_back(&zlib);
+#endif
+        return list;
+    }();
+    return all;
+}
+
+}
+
+const Codec* Codec::find(std::string_view name) {
+    for (const Codec* codec : codecs()) {
+        if (name == codec->name()) return codec;
+    }
+    return nullptr;
+}
+
+std::string Codec::available() {
+    std::string names;
+    for (const Codec* codec : codecs()) {
+        if (!names.empty()) names += ',';
+        names += codec->name();
+    }
+    return names;
+}
+
+const Codec* Codec::choose(std::string_view offer) {
+    while (!offer.empty()) {
+        size_t comma = offer.find(',');
+        if (const Codec* codec = find(offer.substr(0, comma))) return codec;
+        if (comma == std::string_view::npos) break;
+        offer.remove_prefix(comma + 1);
+    }
+    return nullptr;
+}
+
+bool looksCompressible(std::span<const char> chunk) {
+    if (chunk.size() < CHROMA_COMPRESS_MIN_BYTES) return false;
+
+    size_t samples = std::min(chunk.size(), CHROMA_ENTROPY_SAMPLE);
+    size_t stride = chunk.size() / samples;
+    std::array<uint32_t, 256> histogram{};
+    for (size_t i = 0; i < samples; ++i) {
+        histogram[static_cast<uint8_t>(chunk[i * stride])]++;
+    }
+
+    double entropy = 0.0;
+    for (uint32_t count : histogram) {
+        if (count == 0) continue;
+        double p = static_cast<double>(count) / static_cast<double>(samples);
+        entropy -= p * std::log2(p);
+    }
+    // Amostra pequena não chega a 8 bits nem com dado aleatório: o limite
+    // acompanha o máximo possível para o tamanho dela
+    double limit = std::min(CHROMA_INCOMPRESSIBLE_ENTROPY, std::log2(static_cast<double>(samples)) - 0.8);
+    return entropy < limit;
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+#include <string>
+#include <string_view>
+
+constexpr size_t CHROMA_COMPRESS_MIN_BYTES = 128;    // chunk menor sai cru
+constexpr double CHROMA_INCOMPRESSIBLE_ENTROPY = 7.2; // bits/byte na amostra
+constexpr size_t CHROMA_ENTROPY_SAMPLE = 1024;
+
+// Compressão por chunk. Cada codec só existe se a biblioteca foi encontrada
+// no configure (zlib sempre; zstd e LZ4 quando instalados). O cliente oferece
+// os que tem na opção "comp" do GET, o servidor escolhe o primeiro que também
+// tem e anuncia no META, e o ACK do META confirma.
+//
+// Chunk comprimido vai com a flag ZDATA; chunk que não encolhe vai como DATA
+// normal, sem cópia.
+class Codec {
+public:
+    virtual ~Codec() = default;
+
+    [[nodiscard]] virtual const char* name() const = 0;
+
+    // Bytes escritos em `out`, ou 0 se não coube (dado não encolheu)
+    virtual size_t compress(std::span<const char> in, std::span<char> out) const = 0;
+
+    // true se `in` descomprimiu em exatamente out.size() bytes
+    virtual bool decompress(std::span<const char> in, std::span<char> out) const = 0;
+
+    // Codec compilado com esse nome, ou nullptr
+    static const Codec* find(std::string_view name);
+
+    // Nomes compilados, em ordem de preferência, separados por vírgula
+    static std::string available();
+
+    // Primeiro codec de `offer` (lista separada por vírgula) que existe aqui
+    static const Codec* choose(std::string_view offer);
+};
+
+// Sonda de entropia: estima bits/byte numa amostra espaçada do chunk. Dado
+// já comprimido (ou cifrado, ou mídia) fica perto de 8 e nem é tentado.
+bool looksCompressible(std::span<const char> chunk);
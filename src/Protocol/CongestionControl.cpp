@@ -0,0 +1,85 @@
+#include "CongestionControl.hpp"
+
+#include <stdexcept>
+
+double CongestionController::pacingRate(const RttEstimator& rtt) const {
+    if (!rtt.hasEstimate() || rtt.smoothedRttMs() <= 0.0) {
+        return 0.0;
+    }
+    // Ganho acima de 1 para não ficar abaixo da janela por causa do pacing
+    double gain = inSlowStart() ? 2.0 : 1.25;
+    return gain * cwnd / (rtt.smoothedRttMs() / 1000.0);
+}
+
+void NewRenoController::onAck(uint32_t acked, const RttEstimator&, Clock::time_point) {
+    if (inSlowStart()) {
+        cwnd += acked;
+    } else {
+        cwnd += static_cast<double>(acked) / cwnd;
+    }
+}
+
+void NewRenoController::onLoss(Clock::time_point) {
+    ssthresh = std::max<double>(cwnd / 2.0, CHROMA_MIN_CWND);
+    cwnd = ssthresh;
+}
+
+void NewRenoController::onTimeout() {
+    ssthresh = std::max<double>(cwnd / 2.0, CHROMA_MIN_CWND);
+    cwnd = CHROMA_MIN_CWND;
+}
+
+uint32_t NewRenoController::window() const {
+    return static_cast<uint32_t>(std::max<double>(cwnd, CHROMA_MIN_CWND));
+}
+
+void DelayBasedController::onAck(uint32_t acked, const RttEstimator& rtt, Clock::time_point now) {
+    if (!rtt.hasEstimate() || now < nextAdjust) {
+        // Entre ajustes, o slow start continua crescendo por ACK
+        if (inSlowStart()) cwnd += acked;
+        return;
+    }
+
+    // Pacotes estimados na fila do gargalo
+    double baseRtt = rtt.minRttMs();
+    double currentRtt = std::max(rtt.lastRttMs(), baseRtt);
+    double queued = cwnd * (1.0 - baseRtt / currentRtt);
+
+    if (inSlowStart()) {
+        if (queued > gamma) {
+            ssthresh = cwnd;
+        } else {
+            cwnd += acked;
+        }
+    } else if (queued < alpha) {
+        cwnd += 1.0;
+    } else if (queued > beta) {
+        cwnd = std::max<double>(cwnd - 1.0, CHROMA_MIN_CWND);
+    }
+
+    nextAdjust = now + std::chrono::microseconds(static_cast<long long>(rtt.smoothedRttMs() * 1000.0));
+}
+
+void DelayBasedController::onLoss(Clock::time_point) {
+    cwnd = std::max<double>(cwnd * 0.75, CHROMA_MIN_CWND);
+    ssthresh = cwnd;
+}
+
+void DelayBasedController::onTimeout() {
+    ssthresh = std::max<double>(cwnd / 2.0, CHROMA_MIN_CWND);
+    cwnd = CHROMA_MIN_CWND;
+}
+
+uint32_t DelayBasedController::window() const {
+    return static_cast<uint32_t>(std::max<double>(cwnd, CHROMA_MIN_CWND));
+}
+
+std::unique_ptr<CongestionController> makeCongestionController(const std::string& algorithm) {
+    if (algorithm.empty() || algorithm == "newreno") {
+        return std::make_unique<NewRenoController>();
+    }
+    if (algorithm == "vegas") {
+        return std::make_unique<DelayBasedController>();
+    }
+    throw std::invalid_argument("Controle de congestionamento desconhecido: " + algorithm);
+}
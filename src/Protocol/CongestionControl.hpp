@@ -0,0 +1,118 @@
+#pragma once
+
+#include "RttEstimator.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+constexpr uint32_t CHROMA_INITIAL_CWND = 10;     // pacotes (RFC 6928)
+constexpr uint32_t CHROMA_MIN_CWND = 2;
+constexpr uint32_t CHROMA_PACER_BURST = 16;      // pacotes liberados de uma vez
+constexpr uint32_t CHROMA_DUP_THRESHOLD = 3;     // SACKs acima de um buraco para declará-lo perdido
+
+// Controle de congestionamento do emissor. A janela efetiva da sessão é
+// min(janela negociada, window()); todas as unidades são pacotes.
+class CongestionController {
+public:
+    using Clock = RttEstimator::Clock;
+
+    virtual ~CongestionController() = default;
+
+    // `acked` pacotes novos confirmados (cumulativo + SACK)
+    virtual void onAck(uint32_t acked, const RttEstimator& rtt, Clock::time_point now) = 0;
+    // Perda detectada por SACK; chamado uma vez por episódio de recuperação
+    virtual void onLoss(Clock::time_point now) = 0;
+    // Timeout de retransmissão
+    virtual void onTimeout() = 0;
+
+    [[nodiscard]] virtual uint32_t window() const = 0;
+    [[nodiscard]] virtual const char* name() const = 0;
+
+    // Taxa de envio em pacotes/s; 0 desliga o pacing (ainda sem RTT medido)
+    [[nodiscard]] virtual double pacingRate(const RttEstimator& rtt) const;
+
+    [[nodiscard]] bool inSlowStart() const { return cwnd < ssthresh; }
+
+protected:
+    double cwnd{CHROMA_INITIAL_CWND};
+    double ssthresh{1e9};
+};
+
+// Slow start + AIMD com redução à metade por episódio de perda (NewReno)
+class NewRenoController : public CongestionController {
+public:
+    void onAck(uint32_t acked, const RttEstimator& rtt, Clock::time_point now) override;
+    void onLoss(Clock::time_point now) override;
+    void onTimeout() override;
+
+    [[nodiscard]] uint32_t window() const override;
+    [[nodiscard]] const char* name() const override { return "newreno"; }
+};
+
+// Controle baseado em atraso (estilo TCP Vegas): compara a vazão esperada
+// (cwnd / RTT mínimo) com a real (cwnd / RTT atual) e mantém entre alpha e
+// beta pacotes enfileirados no gargalo, reagindo antes de haver perda.
+class DelayBasedController : public CongestionController {
+public:
+    void onAck(uint32_t acked, const RttEstimator& rtt, Clock::time_point now) override;
+    void onLoss(Clock::time_point now) override;
+    void onTimeout() override;
+
+    [[nodiscard]] uint32_t window() const override;
+    [[nodiscard]] const char* name() const override { return "vegas"; }
+
+private:
+    static constexpr double alpha = 2.0;
+    static constexpr double beta = 4.0;
+    static constexpr double gamma = 1.0;
+
+    Clock::time_point nextAdjust{};
+};
+
+// "newreno" (padrão) ou "vegas"
+std::unique_ptr<CongestionController> makeCongestionController(const std::string& algorithm);
+
+// Token bucket que espaça as transmissões na taxa estimada em vez de
+// despejar a janela inteira de uma vez.
+class Pacer {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    void setRate(double packetsPerSecond) { rate = packetsPerSecond; }
+
+    // Quantos pacotes podem sair agora
+    [[nodiscard]] uint32_t allowance(Clock::time_point now) {
+        if (rate <= 0.0) return UINT32_MAX;
+        refill(now);
+        return tokens > 0.0 ? static_cast<uint32_t>(tokens) : 0;
+    }
+
+    // Pode passar da allowance (ex.: paridade que fecha o bloco depois do
+    // último DATA): o excesso vira dívida, paga antes do próximo pacote
+    void consume(uint32_t packets) {
+        if (rate > 0.0) tokens = std::max(-static_cast<double>(CHROMA_PACER_BURST), tokens - packets);
+    }
+
+    // Quanto esperar até liberar o próximo pacote
+    [[nodiscard]] Clock::duration timeUntilNext(Clock::time_point now) {
+        if (rate <= 0.0) return Clock::duration::zero();
+        refill(now);
+        if (tokens >= 1.0) return Clock::duration::zero();
+        return std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double>((1.0 - tokens) / rate));
+    }
+
+private:
+    double rate{0.0};
+    double tokens{CHROMA_PACER_BURST};
+    Clock::time_point lastRefill{Clock::now()};
+
+    void refill(Clock::time_point now) {
+        double elapsed = std::chrono::duration<double>(now - lastRefill).count();
+        tokens = std::min<double>(CHROMA_PACER_BURST, tokens + elapsed * rate);
+        lastRefill = now;
+    }
+};
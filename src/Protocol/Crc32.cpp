@@ -0,0 +1,299 @@
+#include "Crc32.hpp"
+
+#include <array>
+#include <bit>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define CHROMA_CRC_X86 1
+#endif
+
+#if defined(__aarch64__)
+#include <arm_acle.h>
+#include <sys/auxv.h>
+#include <asm/hwcap.h>
+#define CHROMA_CRC_ARM 1
+#endif
+
+namespace {
+
+using Tables = std::array<std::array<uint32_t, 256>, 16>;
+
+// tables[0] é a mesma tabela clássica; tables[k] avança k bytes de zeros
+constexpr Tables makeTables() {
+    Tables t{};
+    for (uint32_t i = 0; i < 256; ++i) {
+        uint32_t c = i;
+        for (int k = 0; k < 8; ++k) {
+            c = (c & 1U) ? (c >> 1) ^ 0xEDB88320U : (c >> 1);
+        }
+        t[0][i] = c;
+    }
+    for (size_t k = 1; k < t.size(); ++k) {
+        for (uint32_t i = 0; i < 256; ++i) {
+            t[k][i] = (t[k - 1][i] >> 8) ^ t[0][t[k - 1][i] & 0xFFU];
+        }
+    }
+    return t;
+}
+
+constexpr Tables tables = makeTables();
+
+uint32_t load32(const unsigned char* p) {
+    uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+uint32_t crcTable(uint32_t crc, const unsigned char* p, size_t len) {
+    while (len--) {
+        crc = (crc >> 8) ^ tables[0][(crc ^ *p++) & 0xFFU];
+    }
+    return crc;
+}
+
+uint32_t crcSlicing8(uint32_t crc, const unsigned char* p, size_t len) {
+    if constexpr (std::endian::native == std::endian::little) {
+        while (len >= 8) {
+            uint32_t one = load32(p) ^ crc;
+            uint32_t two = load32(p + 4);
+            crc = tables[7][one & 0xFF] ^ tables[6][(one >> 8) & 0xFF] ^
+                  tables[5][(one >> 16) & 0xFF] ^ tables[4][one >> 24] ^
+                  tables[3][two & 0xFF] ^ tables[2][(two >> 8) & 0xFF] ^
+                  tables[1][(two >> 16) & 0xFF] ^ tables[0][two >> 24];
+            p += 8;
+            len -= 8;
+        }
+    }
+    return crcTable(crc, p, len);
+}
+
+uint32_t crcSlicing16(uint32_t crc, const unsigned char* p, size_t len) {
+    if constexpr (std::endian::native == std::endian::little) {
+        while (len >= 16) {
+            uint32_t one = load32(p) ^ crc;
+            uint32_t two = load32(p + 4);
+            uint32_t three = load32(p + 8);
+            uint32_t four = load32(p + 12);
+            crc = tables[15][one & 0xFF] ^ tables[14][(one >> 8) & 0xFF] ^
+                  tables[13][(one >> 16) & 0xFF] ^ tables[12][one >> 24] ^
+                  tables[11][two & 0xFF] ^ tables[10][(two >> 8) & 0xFF] ^
+                  tables[9][(two >> 16) & 0xFF] ^ tables[8][two >> 24] ^
+                  tables[7][three & 0xFF] ^ tables[6][(three >> 8) & 0xFF] ^
+                  tables[5][(three >> 16) & 0xFF] ^ tables[4][three >> 24] ^
+                  tables[3][four & 0xFF] ^ tables[2][(four >> 8) & 0xFF] ^
+                  tables[1][(four >> 16) & 0xFF] ^ tables[0][four >> 24];
+            p += 16;
+            len -= 16;
+        }
+    }
+    return crcSlicing8(crc, p, len);
+}
+
+#ifdef CHROMA_CRC_X86
+// Folding com multiplicação sem carry ("Fast CRC Computation for Generic
+// Polynomials Using PCLMULQDQ", Intel), no domínio refletido. Exige len >= 64
+// e múltiplo de 16; o restante é tratado pelo slicing.
+__attribute__((target("sse4.1,pclmul")))
+uint32_t crcPclmulBlocks(uint32_t crc, const unsigned char* buf, size_t len) {
+    alignas(16) static const uint64_t k1k2[] = {0x0154442bd4, 0x01c6e41596};
+    alignas(16) static const uint64_t k3k4[] = {0x01751997d0, 0x00ccaa009e};
+    alignas(16) static const uint64_t k5k0[] = {0x0163cd6124, 0x0000000000};
+    alignas(16) static const uint64_t poly[] = {0x01db710641, 0x01f7011641};
+
+    __m128i x0, x1, x2, x3, x4, x5, x6, x7, x8, y5, y6, y7, y8;
+
+    x1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(buf + 0x00));
+    x2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(buf + 0x10));
+    x3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(buf + 0x20));
+    x4 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(buf + 0x30));
+
+    x1 = _mm_xor_si128(x1, _mm_cvtsi32_si128(static_cast<int>(crc)));
+    x0 = _mm_load_si128(reinterpret_cast<const __m128i*>(k1k2));
+
+    buf += 64;
+    len -= 64;
+
+    // Dobra 4 blocos de 16 bytes em paralelo
+    while (len >= 64) {
+        x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+        x6 = _mm_clmulepi64_si128(x2, x0, 0x00);
+        x7 = _mm_clmulepi64_si128(x3, x0, 0x00);
+        x8 = _mm_clmulepi64_si128(x4, x0, 0x00);
+
+        x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+        x2 = _mm_clmulepi64_si128(x2, x0, 0x11);
+        x3 = _mm_clmulepi64_si128(x3, x0, 0x11);
+        x4 = _mm_clmulepi64_si128(x4, x0, 0x11);
+
+        y5 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(buf + 0x00));
+        y6 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(buf + 0x10));
+        y7 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(buf + 0x20));
+        y8 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(buf + 0x30));
+
+        x1 = _mm_xor_si128(_mm_xor_si128(x1, x5), y5);
+        x2 = _mm_xor_si128(_mm_xor_si128(x2, x6), y6);
+        x3 = _mm_xor_si128(_mm_xor_si128(x3, x7), y7);
+        x4 = _mm_xor_si128(_mm_xor_si128(x4, x8), y8);
+
+        buf += 64;
+        len -= 64;
+    }
+
+    // Reduz os 4 acumuladores para 128 bits
+    x0 = _mm_load_si128(reinterpret_cast<const __m128i*>(k3k4));
+
+    x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+
+    x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x3), x5);
+
+    x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x4), x5);
+
+    // Blocos restantes de 16 bytes
+    while (len >= 16) {
+        x2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(buf));
+
+        x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+        x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+        x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+
+        buf += 16;
+        len -= 16;
+    }
+
+    // 128 -> 64 bits
+    x2 = _mm_clmulepi64_si128(x1, x0, 0x10);
+    x3 = _mm_setr_epi32(~0, 0, ~0, 0);
+    x1 = _mm_srli_si128(x1, 8);
+    x1 = _mm_xor_si128(x1, x2);
+
+    x0 = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(k5k0));
+
+    x2 = _mm_srli_si128(x1, 4);
+    x1 = _mm_and_si128(x1, x3);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_xor_si128(x1, x2);
+
+    // Redução de Barrett para 32 bits
+    x0 = _mm_load_si128(reinterpret_cast<const __m128i*>(poly));
+
+    x2 = _mm_and_si128(x1, x3);
+    x2 = _mm_clmulepi64_si128(x2, x0, 0x10);
+    x2 = _mm_and_si128(x2, x3);
+    x2 = _mm_clmulepi64_si128(x2, x0, 0x00);
+    x1 = _mm_xor_si128(x1, x2);
+
+    return static_cast<uint32_t>(_mm_extract_epi32(x1, 1));
+}
+
+uint32_t crcPclmul(uint32_t crc, const unsigned char* p, size_t len) {
+    if (len >= 64) {
+        size_t blocks = len & ~static_cast<size_t>(15);
+        crc = crcPclmulBlocks(crc, p, blocks);
+        p += blocks;
+        len -= blocks;
+    }
+    return crcSlicing8(crc, p, len);
+}
+#endif
+
+#ifdef CHROMA_CRC_ARM
+__attribute__((target("+crc")))
+uint32_t crcArmv8(uint32_t crc, const unsigned char* p, size_t len) {
+    while (len >= 8) {
+        uint64_t v;
+        std::memcpy(&v, p, sizeof(v));
+        crc = __crc32d(crc, v);
+        p += 8;
+        len -= 8;
+    }
+    while (len--) {
+        crc = __crc32b(crc, *p++);
+    }
+    return crc;
+}
+#endif
+
+using KernelFn = uint32_t (*)(uint32_t, const unsigned char*, size_t);
+
+KernelFn kernelFunction(Crc32::Kernel kernel) {
+    switch (kernel) {
+        case Crc32::Kernel::Table:     return crcTable;
+        case Crc32::Kernel::Slicing8:  return crcSlicing8;
+        case Crc32::Kernel::Slicing16: return crcSlicing16;
+#ifdef CHROMA_CRC_X86
+        case Crc32::Kernel::Pclmul:    return crcPclmul;
+#endif
+#ifdef CHROMA_CRC_ARM
+        case Crc32::Kernel::Armv8:     return crcArmv8;
+#endif
+        default:                       return nullptr;
+    }
+}
+
+Crc32::Kernel detectKernel() {
+    if (Crc32::isSupported(Crc32::Kernel::Pclmul)) return Crc32::Kernel::Pclmul;
+    if (Crc32::isSupported(Crc32::Kernel::Armv8)) return Crc32::Kernel::Armv8;
+    return Crc32::Kernel::Slicing16;
+}
+
+// Resolvido uma única vez, na inicialização estática
+const Crc32::Kernel selectedKernel = detectKernel();
+const KernelFn selectedFunction = kernelFunction(selectedKernel);
+
+} // namespace
+
+bool Crc32::isSupported(Kernel kernel) {
+    switch (kernel) {
+        case Kernel::Table:
+        case Kernel::Slicing8:
+        case Kernel::Slicing16:
+            return true;
+        case Kernel::Pclmul:
+#ifdef CHROMA_CRC_X86
+            return __builtin_cpu_supports("pclmul") && __builtin_cpu_supports("sse4.1");
+#else
+            return false;
+#endif
+        case Kernel::Armv8:
+#ifdef CHROMA_CRC_ARM
+            return (getauxval(AT_HWCAP) & HWCAP_CRC32) != 0;
+#else
+            return false;
+#endif
+    }
+    return false;
+}
+
+uint32_t Crc32::update(uint32_t state, const void* data, size_t len) {
+    KernelFn fn = selectedFunction ? selectedFunction : crcSlicing16;
+    return fn(state, static_cast<const unsigned char*>(data), len);
+}
+
+uint32_t Crc32::computeWith(Kernel kernel, std::span<const char> data) {
+    KernelFn fn = isSupported(kernel) ? kernelFunction(kernel) : nullptr;
+    if (!fn) fn = crcSlicing16;
+    return ~fn(0xFFFFFFFFU, reinterpret_cast<const unsigned char*>(data.data()), data.size());
+}
+
+Crc32::Kernel Crc32::activeKernel() {
+    return selectedKernel;
+}
+
+const char* Crc32::kernelName(Kernel kernel) {
+    switch (kernel) {
+        case Kernel::Table:     return "table";
+        case Kernel::Slicing8:  return "slicing-by-8";
+        case Kernel::Slicing16: return "slicing-by-16";
+        case Kernel::Pclmul:    return "pclmulqdq";
+        case Kernel::Armv8:     return "armv8-crc";
+    }
+    return "?";
+}
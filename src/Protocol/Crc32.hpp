@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+// CRC-32 (IEEE 802.3, polinômio refletido 0xEDB88320) com seleção do kernel
+// em tempo de execução. Todos os kernels produzem exatamente o mesmo valor da
+// tabela byte a byte original, então peers antigos continuam interoperando.
+class Crc32 {
+public:
+    enum class Kernel : uint8_t {
+        Table,      // byte a byte (referência)
+        Slicing8,
+        Slicing16,
+        Pclmul,     // x86 SSE4.1 + PCLMULQDQ (folding)
+        Armv8       // instruções CRC32 do ARMv8
+    };
+
+    // Usa o melhor kernel disponível nesta CPU
+    static uint32_t compute(std::span<const char> data) {
+        return ~update(0xFFFFFFFFU, data.data(), data.size());
+    }
+
+    // Atualiza um estado já invertido (permite calcular o CRC em partes)
+    static uint32_t update(uint32_t state, const void* data, size_t len);
+
+    static uint32_t computeWith(Kernel kernel, std::span<const char> data);
+
+    static bool isSupported(Kernel kernel);
+    static Kernel activeKernel();
+    static const char* kernelName(Kernel kernel);
+};
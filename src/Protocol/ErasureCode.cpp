@@ -0,0 +1,332 @@
+#include "ErasureCode.hpp"
+
+#include <arpa/inet.h>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+namespace {
+
+constexpr size_t SPARE_BUFFERS = 64;          // buffers de símbolo guardados para reuso
+constexpr size_t MAX_TRACKED = 1 << 20;       // pacotes acompanhados além do início da janela
+
+// GF(2^8) com o polinômio 0x11d; tabelas de log/exp e a tabuada completa
+// (64 KiB) para mulAdd ser uma consulta por byte
+struct Field {
+    std::array<uint8_t, 512> exp{};
+    std::array<uint8_t, 256> log{};
+    std::array<std::array<uint8_t, 256>, 256> mul{};
+
+    Field() {
+        unsigned x = 1;
+        for (unsigned i = 0; i < 255; ++i) {
+            exp[i] = static_cast<uint8_t>(x);
+            log[x] = static_cast<uint8_t>(i);
+            x <<= 1;
+            if (x & 0x100) x ^= 0x11d;
+        }
+        for (unsigned i = 255; i < exp.size(); ++i) exp[i] = exp[i - 255];
+
+        for (unsigned a = 1; a < 256; ++a) {
+            for (unsigned b = 1; b < 256; ++b) {
+                mul[a][b] = exp[log[a] + log[b]];
+            }
+        }
+    }
+
+    [[nodiscard]] uint8_t inverse(uint8_t a) const { return exp[255 - log[a]]; }
+};
+
+const Field& field() {
+    static const Field gf;
+    return gf;
+}
+
+// Inverte a matriz n x n (linha a linha em `m`) por Gauss-Jordan; false se singular
+bool invert(std::vector<uint8_t>& m, size_t n) {
+    const Field& gf = field();
+    std::vector<uint8_t> inv(n * n, 0);
+    for (size_t i = 0; i < n; ++i) inv[i * n + i] = 1;
+
+    for (size_t col = 0; col < n; ++col) {
+        size_t pivot = col;
+        while (pivot < n && m[pivot * n + col] == 0) pivot++;
+        if (pivot == n) return false;
+        if (pivot != col) {
+            std::swap_ranges(m.begin() + pivot * n, m.begin() + pivot * n + n, m.begin() + col * n);
+            std::swap_ranges(inv.begin() + pivot * n, inv.begin() + pivot * n + n, inv.begin() + col * n);
+        }
+
+        uint8_t scale = gf.inverse(m[col * n + col]);
+        for (size_t k = 0; k < n; ++k) {
+            m[col * n + k] = gf.mul[scale][m[col * n + k]];
+            inv[col * n + k] = gf.mul[scale][inv[col * n + k]];
+        }
+
+        for (size_t row = 0; row < n; ++row) {
+            uint8_t factor = m[row * n + col];
+            if (row == col || factor == 0) continue;
+            for (size_t k = 0; k < n; ++k) {
+                m[row * n + k] ^= gf.mul[factor][m[col * n + k]];
+                inv[row * n + k] ^= gf.mul[factor][inv[col * n + k]];
+            }
+        }
+    }
+    m.swap(inv);
+    return true;
+}
+
+void writeHeader(char* out, uint64_t first, uint32_t count, uint32_t row) {
+    uint32_t high = htonl(static_cast<uint32_t>(first >> 32));
+    uint32_t low = htonl(static_cast<uint32_t>(first));
+    uint16_t packets = htons(static_cast<uint16_t>(count));
+    std::memcpy(out, &high, sizeof(high));
+    std::memcpy(out + 4, &low, sizeof(low));
+    std::memcpy(out + 8, &packets, sizeof(packets));
+    out[10] = static_cast<char>(row);
+}
+
+}
+
+uint8_t ErasureCode::coefficient(uint32_t row, uint32_t position) {
+    // Cauchy 1 / (x_row + y_pos) com x_row = MAX_BLOCK + row e y_pos = pos,
+    // cada coluna dividida pelo seu valor na linha 0: toda submatriz quadrada
+    // continua inversível e a linha 0 vira só uns (XOR)
+    const Field& gf = field();
+    auto x0 = static_cast<uint8_t>(CHROMA_FEC_MAX_BLOCK);
+    auto x = static_cast<uint8_t>(CHROMA_FEC_MAX_BLOCK + row);
+    auto y = static_cast<uint8_t>(position);
+    return gf.mul[x0 ^ y][gf.inverse(x ^ y)];
+}
+
+void ErasureCode::mulAdd(std::span<char> dst, uint8_t c, std::span<const char> src) {
+    size_t n = std::min(dst.size(), src.size());
+    if (c == 0) return;
+    if (c == 1) {
+        for (size_t i = 0; i < n; ++i) dst[i] ^= src[i];
+        return;
+    }
+    const auto& row = field().mul[c];
+    for (size_t i = 0; i < n; ++i) {
+        dst[i] ^= static_cast<char>(row[static_cast<uint8_t>(src[i])]);
+    }
+}
+
+FecEncoder::FecEncoder(size_t maxPayload)
+    : symbolSize(CHROMA_FEC_SYMBOL_HEADER + maxPayload) {}
+
+void FecEncoder::begin(uint64_t firstIndex, uint32_t maxCount, uint32_t parityRows) {
+    first = firstIndex;
+    count = std::clamp<uint32_t>(maxCount, 1, CHROMA_FEC_MAX_BLOCK);
+    added = 0;
+    parity = std::min(parityRows, CHROMA_FEC_MAX_PARITY);
+    active = true;
+    longest = 0;
+
+    rows.resize(parity);
+    for (uint32_t row = 0; row < parity; ++row) {
+        rows[row].assign(CHROMA_FEC_HEADER + symbolSize, 0);
+    }
+}
+
+bool FecEncoder::add(ChromaFlag flag, std::span<const char> payload) {
+    if (!active || added == count) return false;
+
+    size_t length = std::min(payload.size(), symbolSize - CHROMA_FEC_SYMBOL_HEADER);
+    if (parity > 0) {
+        std::array<char, CHROMA_FEC_SYMBOL_HEADER> header{
+            static_cast<char>(flag), static_cast<char>(length >> 8), static_cast<char>(length & 0xff)};
+        for (uint32_t row = 0; row < parity; ++row) {
+            uint8_t c = ErasureCode::coefficient(row, added);
+            char* symbol = rows[row].data() + CHROMA_FEC_HEADER;
+            ErasureCode::mulAdd({symbol, header.size()}, c, header);
+            ErasureCode::mulAdd({symbol + header.size(), length}, c, payload.first(length));
+        }
+        longest = std::max(longest, CHROMA_FEC_SYMBOL_HEADER + length);
+    }
+    return ++added == count;
+}
+
+void FecEncoder::close() {
+    active = false;
+    for (uint32_t row = 0; row < parity; ++row) {
+        writeHeader(rows[row].data(), first, added, row);
+    }
+}
+
+std::span<const char> FecEncoder::packet(uint32_t row) const {
+    return {rows[row].data(), CHROMA_FEC_HEADER + longest};
+}
+
+FecDecoder::FecDecoder(uint32_t maxBlock, size_t maxPayload)
+    : maxBlock(std::clamp<uint32_t>(maxBlock, 1, CHROMA_FEC_MAX_BLOCK)),
+      symbolSize(CHROMA_FEC_SYMBOL_HEADER + maxPayload) {}
+
+FecDecoder::Symbol* FecDecoder::symbol(uint64_t index) {
+    // Nada fora do que ainda pode estar em voo: pacote antigo ou índice absurdo
+    if (index < windowStart || index - windowStart >= static_cast<uint64_t>(MAX_TRACKED)) return nullptr;
+    while (windowStart + symbols.size() <= index) symbols.emplace_back();
+    return &symbols[static_cast<size_t>(index - windowStart)];
+}
+
+void FecDecoder::onData(uint64_t index, ChromaFlag flag, std::span<const char> payload,
+                        std::vector<Recovered>& recovered) {
+    recovered.clear();
+    Symbol* entry = symbol(index);
+    if (!entry || entry->present) return;
+
+    if (!spare.empty()) {
+        entry->bytes = std::move(spare.back());
+        spare.pop_back();
+    }
+    entry->bytes.resize(symbolSize);
+
+    size_t length = std::min(payload.size(), symbolSize - CHROMA_FEC_SYMBOL_HEADER);
+    char* bytes = entry->bytes.data();
+    bytes[0] = static_cast<char>(flag);
+    bytes[1] = static_cast<char>(length >> 8);
+    bytes[2] = static_cast<char>(length & 0xff);
+    std::memcpy(bytes + CHROMA_FEC_SYMBOL_HEADER, payload.data(), length);
+    std::memset(bytes + CHROMA_FEC_SYMBOL_HEADER + length, 0, symbolSize - CHROMA_FEC_SYMBOL_HEADER - length);
+    entry->present = true;
+
+    // Paridade que chegou antes deste pacote pode ter ficado a um passo
+    auto it = blocks.upper_bound(index);
+    if (it != blocks.begin() && index < (--it)->first + it->second.count) {
+        decode(it, recovered);
+    }
+}
+
+bool FecDecoder::onParity(std::span<const char> payload, std::vector<Recovered>& recovered) {
+    recovered.clear();
+    if (payload.size() < CHROMA_FEC_HEADER + CHROMA_FEC_SYMBOL_HEADER ||
+        payload.size() > CHROMA_FEC_HEADER + symbolSize) {
+        return false;
+    }
+
+    uint32_t high, low;
+    uint16_t packets;
+    std::memcpy(&high, payload.data(), sizeof(high));
+    std::memcpy(&low, payload.data() + 4, sizeof(low));
+    std::memcpy(&packets, payload.data() + 8, sizeof(packets));
+    uint64_t first = (static_cast<uint64_t>(ntohl(high)) << 32) | ntohl(low);
+    uint32_t count = ntohs(packets);
+    auto row = static_cast<uint8_t>(payload[10]);
+    if (count == 0 || count > maxBlock || row >= CHROMA_FEC_MAX_PARITY) return false;
+    if (first + count <= delivered || first < windowStart) return true;   // bloco já entregue
+
+    Block& block = blocks[first];
+    if (block.count == 0) block.count = count;
+    if (block.count != count) return false;
+    for (const auto& [existing, bytes] : block.rows) {
+        if (existing == row) return true;
+    }
+
+    std::vector<char> bytes(symbolSize, 0);
+    std::memcpy(bytes.data(), payload.data() + CHROMA_FEC_HEADER, payload.size() - CHROMA_FEC_HEADER);
+    block.rows.emplace_back(row, std::move(bytes));
+    decode(blocks.find(first), recovered);
+    return true;
+}
+
+void FecDecoder::decode(std::map<uint64_t, Block>::iterator it, std::vector<Recovered>& recovered) {
+    uint64_t first = it->first;
+    Block& block = it->second;
+
+    // A cópia guarda um bloco inteiro antes da base, então um bloco que
+    // começa antes dela já foi todo entregue
+    if (first < windowStart) {
+        blocks.erase(it);
+        return;
+    }
+
+    std::vector<uint32_t> missing;
+    for (uint32_t i = 0; i < block.count; ++i) {
+        Symbol* entry = symbol(first + i);
+        if (!entry) return;
+        if (!entry->present) missing.push_back(i);
+    }
+    size_t e = missing.size();
+    if (e == 0) {
+        blocks.erase(it);   // bloco inteiro sem precisar das paridades
+        return;
+    }
+    if (block.rows.size() < e) return;
+
+    // Síndromes: cada paridade menos a contribuição dos pacotes presentes
+    // sobra só a combinação dos que faltam
+    std::vector<std::vector<char>> syndromes(e);
+    std::vector<uint8_t> matrix(e * e);
+    for (size_t r = 0; r < e; ++r) {
+        uint8_t row = block.rows[r].first;
+        syndromes[r] = block.rows[r].second;
+        size_t next = 0;
+        for (uint32_t i = 0; i < block.count; ++i) {
+            if (next < e && missing[next] == i) {
+                next++;
+                continue;
+            }
+            ErasureCode::mulAdd(syndromes[r], ErasureCode::coefficient(row, i), symbol(first + i)->bytes);
+        }
+        for (size_t c = 0; c < e; ++c) {
+            matrix[r * e + c] = ErasureCode::coefficient(row, missing[c]);
+        }
+    }
+    if (!invert(matrix, e)) return;
+
+    output.clear();
+    output.reserve(e * symbolSize);
+    std::vector<std::pair<uint64_t, size_t>> restored;   // índice, início em output
+    for (size_t c = 0; c < e; ++c) {
+        Symbol* entry = symbol(first + missing[c]);
+        if (!spare.empty()) {
+            entry->bytes = std::move(spare.back());
+            spare.pop_back();
+        }
+        entry->bytes.assign(symbolSize, 0);
+        for (size_t r = 0; r < e; ++r) {
+            ErasureCode::mulAdd(entry->bytes, matrix[c * e + r], syndromes[r]);
+        }
+        entry->present = true;
+
+        const char* bytes = entry->bytes.data();
+        auto flag = static_cast<ChromaFlag>(bytes[0]);
+        size_t length = (static_cast<uint8_t>(bytes[1]) << 8) | static_cast<uint8_t>(bytes[2]);
+        if ((flag != ChromaFlag::DATA && flag != ChromaFlag::ZDATA) ||
+            length > symbolSize - CHROMA_FEC_SYMBOL_HEADER) {
+            entry->present = false;   // paridade inconsistente: fica para a retransmissão
+            continue;
+        }
+        restored.emplace_back(first + missing[c], output.size());
+        output.insert(output.end(), bytes, bytes + CHROMA_FEC_SYMBOL_HEADER + length);
+    }
+    blocks.erase(it);
+
+    for (auto [index, start] : restored) {
+        const char* bytes = output.data() + start;
+        size_t length = (static_cast<uint8_t>(bytes[1]) << 8) | static_cast<uint8_t>(bytes[2]);
+        recovered.push_back({index, static_cast<ChromaFlag>(bytes[0]), {bytes + CHROMA_FEC_SYMBOL_HEADER, length}});
+    }
+    recoveredTotal += restored.size();
+}
+
+void FecDecoder::release(uint64_t index) {
+    delivered = std::max(delivered, index);
+
+    // Mantém um bloco inteiro antes da base: um bloco que começa lá atrás
+    // ainda pode ter o buraco que segura a base
+    while (!symbols.empty() && windowStart + maxBlock < delivered) {
+        Symbol& front = symbols.front();
+        if (front.bytes.capacity() > 0 && spare.size() < SPARE_BUFFERS) {
+            spare.push_back(std::move(front.bytes));
+        }
+        symbols.pop_front();
+        windowStart++;
+    }
+    if (symbols.empty()) windowStart = std::max(windowStart, delivered > maxBlock ? delivered - maxBlock : 0);
+
+    while (!blocks.empty() && blocks.begin()->first + blocks.begin()->second.count <= delivered) {
+        blocks.erase(blocks.begin());
+    }
+}
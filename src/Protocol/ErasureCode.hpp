@@ -0,0 +1,125 @@
+#pragma once
+
+#include "Packet.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <span>
+#include <vector>
+
+constexpr uint32_t CHROMA_FEC_MAX_BLOCK = 128;       // pacotes de dados por bloco
+constexpr uint32_t CHROMA_FEC_MAX_PARITY = 16;       // paridades por bloco
+constexpr uint32_t CHROMA_FEC_DEFAULT_BLOCK = 16;
+constexpr uint32_t CHROMA_FEC_DEFAULT_PARITY = 4;    // teto da redundância adaptativa
+constexpr size_t CHROMA_FEC_HEADER = 11;             // índice do 1º pacote(8) + pacotes(2) + linha(1)
+constexpr size_t CHROMA_FEC_SYMBOL_HEADER = 3;       // flag(1) + tamanho(2) do pacote protegido
+constexpr size_t CHROMA_FEC_OVERHEAD = CHROMA_FEC_HEADER + CHROMA_FEC_SYMBOL_HEADER;
+
+// Código de apagamento sobre GF(2^8) para blocos de pacotes DATA/ZDATA. Cada
+// pacote do bloco vira um símbolo [flag | tamanho | payload] completado com
+// zeros, e a paridade da linha j é a soma dos símbolos pesados por uma matriz
+// de Cauchy normalizada para a linha 0 ser toda de uns: com uma paridade o
+// código é um XOR simples; com m paridades quaisquer m perdas do bloco se
+// recuperam (Reed-Solomon). Os coeficientes só dependem da linha e da posição
+// no bloco, então o servidor pode variar m de um bloco para outro.
+//
+// Pacote de paridade (flag FEC): índice absoluto do primeiro pacote do bloco
+// no trecho, quantos pacotes o bloco tem e a linha, seguidos do símbolo.
+// Os blocos são consecutivos e nunca maiores que o anunciado no META.
+namespace ErasureCode {
+    // Coeficiente do pacote `position` do bloco na linha de paridade `row`
+    uint8_t coefficient(uint32_t row, uint32_t position);
+
+    // dst[i] ^= c * src[i]
+    void mulAdd(std::span<char> dst, uint8_t c, std::span<const char> src);
+}
+
+// Lado do servidor: acumula a paridade do bloco corrente à medida que os
+// pacotes saem, sem guardar os pacotes. O bloco fecha ao chegar no tamanho
+// pedido ou antes, quando o emissor fica sem janela: a paridade de um bloco
+// parcial é só o acumulado até ali, porque os coeficientes não dependem do
+// tamanho final.
+class FecEncoder {
+public:
+    explicit FecEncoder(size_t maxPayload = CHROMA_MAX_DATA);
+
+    // Abre um bloco de até `maxCount` pacotes a partir do índice `first`, com
+    // até `parity` linhas de paridade (0 = bloco sem proteção)
+    void begin(uint64_t first, uint32_t maxCount, uint32_t parity);
+
+    // Soma o próximo pacote do bloco; true quando o bloco encheu
+    bool add(ChromaFlag flag, std::span<const char> payload);
+
+    // Fecha o bloco com os pacotes somados até agora
+    void close();
+
+    [[nodiscard]] bool open() const { return active; }
+    [[nodiscard]] uint32_t size() const { return added; }
+    [[nodiscard]] uint32_t parityCount() const { return parity; }
+
+    // Payload do pacote de paridade `row` do bloco fechado
+    [[nodiscard]] std::span<const char> packet(uint32_t row) const;
+
+private:
+    size_t symbolSize;
+    uint64_t first{0};
+    uint32_t count{0};
+    uint32_t added{0};
+    uint32_t parity{0};
+    bool active{false};
+    size_t longest{0};                       // maior símbolo do bloco
+    std::vector<std::vector<char>> rows;     // cabeçalho + símbolo de paridade
+};
+
+// Lado do cliente: guarda uma cópia dos pacotes recentes (da base menos um
+// bloco em diante) e, quando chegam paridades suficientes para um bloco,
+// reconstrói os pacotes que faltam nele.
+class FecDecoder {
+public:
+    struct Recovered {
+        uint64_t index;
+        ChromaFlag flag;
+        std::span<const char> payload;   // válido até a próxima chamada
+    };
+
+    // `maxBlock` = maior bloco anunciado no META
+    FecDecoder(uint32_t maxBlock, size_t maxPayload);
+
+    // Pacote `index` entregue (recebido ou retransmitido)
+    void onData(uint64_t index, ChromaFlag flag, std::span<const char> payload,
+                std::vector<Recovered>& recovered);
+
+    // Pacote de paridade; false se o cabeçalho é inválido
+    bool onParity(std::span<const char> payload, std::vector<Recovered>& recovered);
+
+    // Tudo antes de `index` já foi entregue
+    void release(uint64_t index);
+
+    // Pacotes reconstruídos desde o início da sessão
+    [[nodiscard]] uint64_t recoveredCount() const { return recoveredTotal; }
+
+private:
+    struct Symbol {
+        bool present{false};
+        std::vector<char> bytes;   // [flag | tamanho | payload | zeros]
+    };
+    struct Block {
+        uint32_t count{0};
+        std::vector<std::pair<uint8_t, std::vector<char>>> rows;   // linha, símbolo
+    };
+
+    uint32_t maxBlock;
+    size_t symbolSize;
+    uint64_t recoveredTotal{0};
+    uint64_t delivered{0};                  // tudo antes disso já foi entregue
+    uint64_t windowStart{0};                // índice de symbols.front()
+    std::deque<Symbol> symbols;
+    std::map<uint64_t, Block> blocks;       // paridades pendentes, pelo 1º índice
+    std::vector<std::vector<char>> spare;   // buffers de símbolos para reaproveitar
+    std::vector<char> output;               // payloads reconstruídos da última chamada
+
+    Symbol* symbol(uint64_t index);
+    void decode(std::map<uint64_t, Block>::iterator it, std::vector<Recovered>& recovered);
+};
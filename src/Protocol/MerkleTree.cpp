@@ -0,0 +1,128 @@
+#include "MerkleTree.hpp"
+
+#include <openssl/evp.h>
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+
+constexpr uint8_t LEAF_PREFIX = 0x00;
+constexpr uint8_t NODE_PREFIX = 0x01;
+
+MerkleTree::Digest sha256(uint8_t prefix, std::span<const char> first, std::span<const char> second = {}) {
+    EVP_MD_CTX* ctx = EVP_MD_CTX_new();
+    MerkleTree::Digest digest{};
+    unsigned int length = 0;
+    bool ok = ctx &&
+              EVP_DigestInit_ex(ctx, EVP_sha256(), nullptr) == 1 &&
+              EVP_DigestUpdate(ctx, &prefix, 1) == 1 &&
+              EVP_DigestUpdate(ctx, first.data(), first.size()) == 1 &&
+              EVP_DigestUpdate(ctx, second.data(), second.size()) == 1 &&
+              EVP_DigestFinal_ex(ctx, digest.data(), &length) == 1;
+    EVP_MD_CTX_free(ctx);
+    if (!ok) throw std::runtime_error("Falha ao calcular SHA-256");
+    return digest;
+}
+
+std::span<const char> asChars(const MerkleTree::Digest& digest) {
+    return {reinterpret_cast<const char*>(digest.data()), digest.size()};
+}
+
+}
+
+MerkleTree::Digest MerkleTree::hashLeaf(std::span<const char> block) {
+    return sha256(LEAF_PREFIX, block);
+}
+
+MerkleTree::Digest MerkleTree::hashNode(const Digest& left, const Digest& right) {
+    return sha256(NODE_PREFIX, asChars(left), asChars(right));
+}
+
+MerkleTree::Digest MerkleTree::computeRoot(std::span<const Digest> leaves) {
+    if (leaves.empty()) return hashLeaf({});
+
+    std::vector<Digest> level(leaves.begin(), leaves.end());
+    while (level.size() > 1) {
+        std::vector<Digest> parent;
+        parent.reserve((level.size() + 1) / 2);
+        for (size_t i = 0; i + 1 < level.size(); i += 2) {
+            parent.push_back(hashNode(level[i], level[i + 1]));
+        }
+        if (level.size() % 2) parent.push_back(level.back());
+        level = std::move(parent);
+    }
+    return level.front();
+}
+
+MerkleTree MerkleTree::build(std::span<const char> file, const std::string& version) {
+    MerkleTree tree;
+    tree.fileSize = file.size();
+    tree.version = version;
+    tree.leaves.resize((file.size() + tree.leafSize - 1) / tree.leafSize);
+
+    for (size_t i = 0; i < tree.leaves.size(); ++i) {
+        uint64_t offset = i * tree.leafSize;
+        tree.leaves[i] = hashLeaf(file.subspan(offset, std::min<uint64_t>(tree.leafSize, file.size() - offset)));
+    }
+
+    tree.root = computeRoot(tree.leaves);
+    return tree;
+}
+
+std::string MerkleTree::toHex(const Digest& digest) {
+    static constexpr char DIGITS[] = "0123456789abcdef";
+    std::string hex;
+    hex.reserve(digest.size() * 2);
+    for (uint8_t byte : digest) {
+        hex.push_back(DIGITS[byte >> 4]);
+        hex.push_back(DIGITS[byte & 0xF]);
+    }
+    return hex;
+}
+
+std::vector<char> MerkleTree::encodeLeaves() const {
+    std::vector<char> out;
+    auto appendStr = [&](const std::string& s) {
+        out.insert(out.end(), s.begin(), s.end());
+        out.push_back('\0');
+    };
+    appendStr(std::to_string(leafSize));
+    appendStr(std::to_string(fileSize));
+    appendStr(version);
+    for (const Digest& leaf : leaves) {
+        std::span<const char> bytes = asChars(leaf);
+        out.insert(out.end(), bytes.begin(), bytes.end());
+    }
+    return out;
+}
+
+std::optional<MerkleTree> MerkleTree::decodeLeaves(std::span<const char> bytes) {
+    MerkleTree tree;
+    size_t pos = 0;
+    auto readStr = [&](std::string& s) {
+        const char* end = static_cast<const char*>(std::memchr(bytes.data() + pos, '\0', bytes.size() - pos));
+        if (!end) return false;
+        s.assign(bytes.data() + pos, end);
+        pos = static_cast<size_t>(end - bytes.data()) + 1;
+        return true;
+    };
+
+    std::string leafStr, sizeStr;
+    if (!readStr(leafStr) || !readStr(sizeStr) || !readStr(tree.version)) return std::nullopt;
+    tree.leafSize = std::strtoull(leafStr.c_str(), nullptr, 10);
+    tree.fileSize = std::strtoull(sizeStr.c_str(), nullptr, 10);
+    if (tree.leafSize == 0) return std::nullopt;
+
+    uint64_t count = (tree.fileSize + tree.leafSize - 1) / tree.leafSize;
+    if (bytes.size() - pos != count * sizeof(Digest)) return std::nullopt;
+
+    tree.leaves.resize(count);
+    for (Digest& leaf : tree.leaves) {
+        std::memcpy(leaf.data(), bytes.data() + pos, leaf.size());
+        pos += leaf.size();
+    }
+    tree.root = computeRoot(tree.leaves);
+    return tree;
+}
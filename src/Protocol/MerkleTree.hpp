@@ -0,0 +1,41 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+constexpr uint64_t CHROMA_MERKLE_LEAF = 1024 * 1024;   // bytes do arquivo por folha
+
+// Árvore de Merkle (SHA-256, via OpenSSL) sobre blocos de CHROMA_MERKLE_LEAF
+// bytes do arquivo. Folhas e nós usam prefixos diferentes (0x00 / 0x01) para
+// uma folha não se passar por nó; nó sem irmão sobe sem ser re-hasheado.
+//
+// O servidor manda a raiz no META e as folhas como um arquivo à parte (GET
+// com "leaves"); o cliente confere as folhas contra a raiz e depois cada
+// bloco recebido contra a sua folha.
+struct MerkleTree {
+    using Digest = std::array<uint8_t, 32>;
+
+    uint64_t leafSize{CHROMA_MERKLE_LEAF};
+    uint64_t fileSize{0};
+    std::string version;
+    std::vector<Digest> leaves;
+    Digest root{};
+
+    // Passada única pelo arquivo; o paralelismo fica com quem chama (HashPool)
+    static MerkleTree build(std::span<const char> file, const std::string& version);
+
+    static Digest hashLeaf(std::span<const char> block);
+    static Digest hashNode(const Digest& left, const Digest& right);
+    static Digest computeRoot(std::span<const Digest> leaves);
+
+    static std::string toHex(const Digest& digest);
+
+    // Formato: "<leafSize>\0<fileSize>\0<versão>\0" seguido das folhas
+    [[nodiscard]] std::vector<char> encodeLeaves() const;
+    static std::optional<MerkleTree> decodeLeaves(std::span<const char> bytes);
+};
@@ -0,0 +1,261 @@
+#pragma once
+
+#include "Crc32.hpp"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#define WINDOW_SIZE 127           // limite do formato legado (seq de 8 bits)
+#define WIDE_WINDOW_SIZE 4096     // janela padrão com seq de 32 bits
+#define MAX_WIDE_WINDOW_SIZE 16384
+#define BUFFER_SIZE 256
+
+// Versões do formato de fio. O handshake (GET/META/ACK do META) sempre usa a
+// versão legada; a versão larga só é usada depois de negociada no META/ACK.
+constexpr uint8_t CHROMA_VERSION_LEGACY = 1;  // seq de 8 bits
+constexpr uint8_t CHROMA_VERSION_WIDE = 2;    // seq de 32 bits
+
+constexpr size_t UDP_MAX_PAYLOAD = 1472;      // 1500 - 20 (IP) - 8 (UDP)
+constexpr size_t CHROMA_HEADER_SIZE = 10;     // seq(1) + flag(1) + dsize(4) + checksum(4)
+constexpr size_t CHROMA_WIDE_HEADER_SIZE = 13; // seq(4) + flag(1) + dsize(4) + checksum(4)
+constexpr size_t CHROMA_MAX_HEADER_SIZE = CHROMA_WIDE_HEADER_SIZE;
+constexpr size_t CHROMA_MAX_DATA = UDP_MAX_PAYLOAD - CHROMA_MAX_HEADER_SIZE;
+constexpr size_t CHROMA_LEGACY_MAX_DATA = UDP_MAX_PAYLOAD - CHROMA_HEADER_SIZE; // chunk de servidor sem "chunk" no META
+constexpr size_t CHROMA_BATCH_SIZE = 64;      // datagramas por sendmmsg/recvmmsg
+constexpr size_t CHROMA_GSO_MAX_SEGMENTS = 64; // limite do kernel por envio com UDP_SEGMENT
+constexpr size_t CHROMA_OFFLOAD_MAX_BYTES = 65507; // maior payload UDP sobre IPv4
+constexpr size_t CHROMA_GRO_SLOTS = 16;       // buffers de recepção com UDP_GRO
+constexpr size_t CHROMA_JUMBO_DATAGRAM = 8972; // 9000 - 20 (IP) - 8 (UDP)
+constexpr int CHROMA_BULK_SOCKET_BUFFER = 8 * 1024 * 1024; // SO_RCVBUF/SO_SNDBUF com datagramas grandes
+
+constexpr uint32_t CHROMA_ACK_EVERY = 16;     // DATA recebidos por SACK
+constexpr int CHROMA_DELAYED_ACK_MS = 10;     // atraso máximo de um SACK pendente
+constexpr size_t CHROMA_SACK_MAX_BITS = 8 * 1024;
+constexpr int CHROMA_BUSY_RETRY_MS = 250;     // espera base depois de um BUSY
+constexpr int CHROMA_QUEUE_KEEPALIVE_MS = 2000; // intervalo pedido a quem está na fila
+
+enum class ChromaFlag : uint8_t {
+    UNKNOWN = 0,
+    GET,
+    DATA,
+    ACK,
+    NACK,
+    END,
+    META,
+    SACK,   // ACK cumulativo + bitmap seletivo (só no formato largo)
+    BUSY,   // servidor lotado; opção "retry" = ms até tentar de novo e, se o
+            // GET ficou na fila, "queued" = posição (repetir o GET a mantém);
+            // "queued=0": a sessão existe e prepara o arquivo (assinatura, Merkle)
+    PROBE,  // sonda de PMTU; o cliente devolve o mesmo seq
+    ZDATA,  // DATA com o chunk comprimido pelo codec negociado no META
+    FEC     // paridade de um bloco de DATA/ZDATA (ErasureCode.hpp)
+};
+
+// Visão não-proprietária de um datagrama recebido: o payload aponta direto
+// para o buffer de recepção e só é válido até a próxima chamada de recvPacket.
+struct PacketView {
+    uint32_t seqNum{0};
+    ChromaFlag flag{ChromaFlag::UNKNOWN};
+    uint32_t checksum{0};
+    std::span<const char> data;
+    sockaddr_in srcAddr{};
+};
+
+class Packet {
+public:
+    uint32_t seqNum{0};
+    ChromaFlag flag{ChromaFlag::UNKNOWN};
+    uint32_t checksum{0};             
+    std::vector<char> data;
+    sockaddr_in srcAddr{};
+
+    Packet() = default;
+
+    Packet(uint32_t seq, const std::vector<char>& d, ChromaFlag f, sockaddr_in src = {})
+        : seqNum(seq), flag(f), data(d), srcAddr(src) {
+        checksum = computeChecksum(data);
+        std::memset(&srcAddr, 0, sizeof(srcAddr));
+    }
+
+    Packet(uint32_t seq, std::vector<char>&& d, ChromaFlag f, sockaddr_in src = {})
+        : seqNum(seq), flag(f), data(std::move(d)), srcAddr(src) {
+        checksum = computeChecksum(data);
+        std::memset(&srcAddr, 0, sizeof(srcAddr));
+    }
+
+    explicit Packet(const PacketView& view)
+        : seqNum(view.seqNum), flag(view.flag), checksum(view.checksum),
+          data(view.data.begin(), view.data.end()), srcAddr(view.srcAddr) {}
+
+    static constexpr size_t headerSize(uint8_t version) {
+        return version == CHROMA_VERSION_WIDE ? CHROMA_WIDE_HEADER_SIZE : CHROMA_HEADER_SIZE;
+    }
+
+    // Escreve o cabeçalho em `out` (pelo menos CHROMA_MAX_HEADER_SIZE bytes)
+    // e retorna quantos bytes ocupou.
+    static size_t encodeHeader(char* out, uint8_t version, uint32_t seq, ChromaFlag f,
+                               uint32_t dsize, uint32_t chk) {
+        size_t offset = 0;
+
+        // seqNum (1 byte no formato legado, 4 bytes no largo)
+        if (version == CHROMA_VERSION_WIDE) {
+            uint32_t seq_n = htonl(seq);
+            std::memcpy(out, &seq_n, sizeof(seq_n));
+            offset += sizeof(seq_n);
+        } else {
+            out[offset++] = static_cast<char>(static_cast<uint8_t>(seq));
+        }
+
+        // flag (1 byte)
+        out[offset++] = static_cast<char>(f);
+
+        // tamanho dos dados (4 bytes)
+        uint32_t dsize_n = htonl(dsize);
+        std::memcpy(out + offset, &dsize_n, sizeof(dsize_n));
+        offset += sizeof(dsize_n);
+
+        // checksum (4 bytes)
+        uint32_t chk_n = htonl(chk);
+        std::memcpy(out + offset, &chk_n, sizeof(chk_n));
+        offset += sizeof(chk_n);
+
+        return offset;
+    }
+
+    size_t encodeHeader(char* out, uint8_t version = CHROMA_VERSION_LEGACY) const {
+        return encodeHeader(out, version, seqNum, flag, static_cast<uint32_t>(data.size()), checksum);
+    }
+
+    // Interpreta o datagrama no próprio buffer, sem copiar o payload.
+    static bool parse(std::span<const char> buffer, uint8_t version, PacketView& view) {
+        const size_t hdr = headerSize(version);
+        if (buffer.size() < hdr) {
+            return false;
+        }
+
+        size_t offset = 0;
+        if (version == CHROMA_VERSION_WIDE) {
+            uint32_t seq_n{};
+            std::memcpy(&seq_n, buffer.data(), sizeof(seq_n));
+            view.seqNum = ntohl(seq_n);
+            offset += sizeof(seq_n);
+        } else {
+            view.seqNum = static_cast<uint8_t>(buffer[offset++]);
+        }
+
+        view.flag = static_cast<ChromaFlag>(static_cast<unsigned char>(buffer[offset++]));
+
+        uint32_t dsize_n{};
+        std::memcpy(&dsize_n, buffer.data() + offset, sizeof(dsize_n));
+        uint32_t dsize = ntohl(dsize_n);
+        offset += sizeof(dsize_n);
+
+        uint32_t chk_n{};
+        std::memcpy(&chk_n, buffer.data() + offset, sizeof(chk_n));
+        view.checksum = ntohl(chk_n);
+
+        if (buffer.size() < hdr + dsize) {
+            return false;
+        }
+
+        view.data = buffer.subspan(hdr, dsize);
+        return true;
+    }
+
+    [[nodiscard]] std::vector<char> serialize(uint8_t version = CHROMA_VERSION_LEGACY) const {
+        const size_t hdr = headerSize(version);
+        std::vector<char> buffer(hdr + data.size());
+        encodeHeader(buffer.data(), version);
+        std::memcpy(buffer.data() + hdr, data.data(), data.size());
+        return buffer;
+    }
+
+    void deserialize(const std::vector<char>& buffer, const sockaddr_in& src,
+                     uint8_t version = CHROMA_VERSION_LEGACY) {
+        PacketView view;
+        if (buffer.size() < headerSize(version)) {
+            throw std::runtime_error("Buffer menor que cabeçalho mínimo");
+        }
+        if (!parse(buffer, version, view)) {
+            throw std::runtime_error("Buffer inconsistente: tamanho insuficiente");
+        }
+
+        seqNum = view.seqNum;
+        flag = view.flag;
+        checksum = view.checksum;
+        data.assign(view.data.begin(), view.data.end());
+        srcAddr = src;
+    }
+
+    static uint32_t computeChecksum(std::span<const char> d) {
+        return Crc32::compute(d);
+    }
+};
+
+// Referência a um pacote a ser enviado em lote; o payload não é copiado.
+struct OutgoingPacket {
+    uint32_t seqNum{0};
+    ChromaFlag flag{ChromaFlag::UNKNOWN};
+    uint32_t checksum{0};
+    std::span<const char> data;
+
+    OutgoingPacket() = default;
+
+    OutgoingPacket(const Packet& pkt)
+        : seqNum(pkt.seqNum), flag(pkt.flag), checksum(pkt.checksum), data(pkt.data) {}
+
+    OutgoingPacket(uint32_t seq, ChromaFlag f, std::span<const char> d = {})
+        : seqNum(seq), flag(f), checksum(Packet::computeChecksum(d)), data(d) {}
+};
+
+// Payload do SACK: seq cumulativo (próximo esperado; tudo antes dele chegou),
+// tamanho do bitmap em bytes e o bitmap, onde o bit i indica que o seq
+// cumulativo + 1 + i já foi recebido fora de ordem.
+struct SackView {
+    uint32_t cumulative{0};
+    std::span<const uint8_t> bitmap;
+    std::span<const char> options;   // extensões "chave=valor" depois do bitmap
+
+    static bool parse(std::span<const char> data, SackView& out) {
+        if (data.size() < sizeof(uint32_t) + sizeof(uint16_t)) return false;
+
+        uint32_t cum_n{};
+        std::memcpy(&cum_n, data.data(), sizeof(cum_n));
+        out.cumulative = ntohl(cum_n);
+
+        uint16_t len_n{};
+        std::memcpy(&len_n, data.data() + sizeof(cum_n), sizeof(len_n));
+        size_t len = ntohs(len_n);
+
+        size_t offset = sizeof(cum_n) + sizeof(len_n);
+        if (data.size() < offset + len) return false;
+
+        out.bitmap = {reinterpret_cast<const uint8_t*>(data.data() + offset), len};
+        out.options = data.subspan(offset + len);
+        return true;
+    }
+
+    [[nodiscard]] bool has(size_t i) const {
+        return i / 8 < bitmap.size() && ((bitmap[i / 8] >> (i % 8)) & 1U);
+    }
+
+    // Reescreve `out` com o cabeçalho do SACK e `bitmapBytes` bytes zerados
+    static void encodeHeader(std::vector<char>& out, uint32_t cumulative, size_t bitmapBytes) {
+        out.assign(sizeof(uint32_t) + sizeof(uint16_t) + bitmapBytes, 0);
+        uint32_t cum_n = htonl(cumulative);
+        std::memcpy(out.data(), &cum_n, sizeof(cum_n));
+        uint16_t len_n = htons(static_cast<uint16_t>(bitmapBytes));
+        std::memcpy(out.data() + sizeof(cum_n), &len_n, sizeof(len_n));
+    }
+
+    static void setBit(std::vector<char>& out, size_t i) {
+        out[sizeof(uint32_t) + sizeof(uint16_t) + i / 8] |= static_cast<char>(1U << (i % 8));
+    }
+};
@@ -0,0 +1,159 @@
+#pragma once
+
+#include "Packet.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <vector>
+
+// Buffer circular de pacotes indexado por seq % capacidade. Toda a memória de
+// payload é alocada uma única vez em reset(); inserir, buscar e remover são
+// O(1) e a ocupação fica num bitmap, o que permite achar sequências contíguas
+// sem percorrer os slots um a um. A capacidade deve cobrir a janela, de modo
+// que cada slot só possa conter um seq da janela corrente.
+class PacketRing {
+public:
+    struct Slot {
+        uint32_t seqNum{0};
+        ChromaFlag flag{ChromaFlag::UNKNOWN};
+        uint32_t checksum{0};
+        uint32_t length{0};
+        const char* payload{nullptr};   // o que vai no fio: storage ou memória externa
+        char* storage{nullptr};         // área própria de slotBytes() bytes
+
+        // Controle de retransmissão (só usado pelo emissor)
+        std::chrono::steady_clock::time_point sentAt{};
+        uint16_t transmissions{0};
+        int rtoMs{0};
+        uint64_t timer{0};   // handle na TimingWheel; 0 = sem timer armado
+
+        [[nodiscard]] std::span<const char> data() const { return {payload, length}; }
+        operator OutgoingPacket() const {
+            OutgoingPacket out;
+            out.seqNum = seqNum;
+            out.flag = flag;
+            out.checksum = checksum;
+            out.data = data();
+            return out;
+        }
+    };
+
+    // Garante pelo menos `minCapacity` slots de `slotBytes` bytes e esvazia o anel.
+    // Só realoca se a geometria mudou.
+    void reset(size_t minCapacity, size_t slotBytes) {
+        size_t capacity = std::bit_ceil(std::max<size_t>(minCapacity, 1));
+        if (capacity != slots.size() || slotBytes != slotSize) {
+            slots.assign(capacity, Slot{});
+            storage.assign(capacity * slotBytes, 0);
+            occupied.assign((capacity + 63) / 64, 0);
+            slotSize = slotBytes;
+            mask = capacity - 1;
+            for (size_t i = 0; i < capacity; ++i) {
+                slots[i].storage = storage.data() + i * slotBytes;
+                slots[i].payload = slots[i].storage;
+            }
+        }
+        clear();
+    }
+
+    void clear() {
+        std::fill(occupied.begin(), occupied.end(), 0);
+        count = 0;
+    }
+
+    // Reserva o slot de `seq`; o chamador escreve até slotBytes() em storage.
+    Slot& acquire(uint32_t seq, ChromaFlag flag) {
+        size_t idx = seq & mask;
+        if (!isOccupied(idx)) {
+            occupied[idx / 64] |= (uint64_t{1} << (idx % 64));
+            count++;
+        }
+        Slot& slot = slots[idx];
+        slot.seqNum = seq;
+        slot.flag = flag;
+        slot.payload = slot.storage;
+        slot.length = 0;
+        slot.transmissions = 0;
+        slot.timer = 0;
+        return slot;
+    }
+
+    // Copia o payload para o slot (até slotBytes()) e calcula o checksum.
+    Slot& store(uint32_t seq, ChromaFlag flag, std::span<const char> data) {
+        Slot& slot = acquire(seq, flag);
+        slot.length = static_cast<uint32_t>(std::min(data.size(), slotSize));
+        std::memcpy(slot.storage, data.data(), slot.length);
+        slot.checksum = Packet::computeChecksum(slot.data());
+        return slot;
+    }
+
+    // Aponta o slot para memória de fora do anel, sem copiar; `data` precisa
+    // continuar válido enquanto o slot estiver ocupado.
+    Slot& attach(uint32_t seq, ChromaFlag flag, std::span<const char> data) {
+        Slot& slot = acquire(seq, flag);
+        slot.payload = data.data();
+        slot.length = static_cast<uint32_t>(data.size());
+        slot.checksum = Packet::computeChecksum(slot.data());
+        return slot;
+    }
+
+    [[nodiscard]] Slot* find(uint32_t seq) {
+        size_t idx = seq & mask;
+        if (slots.empty() || !isOccupied(idx) || slots[idx].seqNum != seq) return nullptr;
+        return &slots[idx];
+    }
+
+    [[nodiscard]] bool contains(uint32_t seq) const {
+        size_t idx = seq & mask;
+        return !slots.empty() && isOccupied(idx) && slots[idx].seqNum == seq;
+    }
+
+    bool erase(uint32_t seq) {
+        if (!contains(seq)) return false;
+        size_t idx = seq & mask;
+        occupied[idx / 64] &= ~(uint64_t{1} << (idx % 64));
+        count--;
+        return true;
+    }
+
+    // Quantos slots ocupados consecutivos existem a partir de `seq`,
+    // contando bits do bitmap em vez de testar slot a slot.
+    [[nodiscard]] size_t contiguousFrom(uint32_t seq) const {
+        if (slots.empty()) return 0;
+        size_t run = 0;
+        size_t idx = seq & mask;
+        while (run < slots.size()) {
+            uint64_t word = occupied[idx / 64] >> (idx % 64);
+            size_t bitsInWord = std::min<size_t>(64 - idx % 64, slots.size() - idx);
+            size_t ones = static_cast<size_t>(std::countr_one(word));
+            if (ones < bitsInWord) {
+                run += ones;
+                break;
+            }
+            run += bitsInWord;
+            idx = (idx + bitsInWord) & mask;
+        }
+        return std::min(run, slots.size());
+    }
+
+    [[nodiscard]] bool empty() const { return count == 0; }
+    [[nodiscard]] size_t size() const { return count; }
+    [[nodiscard]] size_t capacity() const { return slots.size(); }
+    [[nodiscard]] size_t slotBytes() const { return slotSize; }
+
+private:
+    std::vector<Slot> slots;
+    std::vector<char> storage;
+    std::vector<uint64_t> occupied;
+    size_t slotSize{0};
+    size_t mask{0};
+    size_t count{0};
+
+    [[nodiscard]] bool isOccupied(size_t idx) const {
+        return (occupied[idx / 64] >> (idx % 64)) & 1U;
+    }
+};
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+constexpr int CHROMA_INITIAL_RTO_MS = 1000;   // RFC 6298, até a primeira amostra
+constexpr int CHROMA_MIN_RTO_MS = 50;
+constexpr int CHROMA_MAX_RTO_MS = 8000;
+
+// Estimador de RTT de Jacobson/Karels (RFC 6298). Só deve receber amostras
+// de pacotes transmitidos uma única vez (regra de Karn); timeouts dobram o
+// RTO até a próxima amostra válida.
+class RttEstimator {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    void addSample(Clock::duration rtt) {
+        double sample = std::chrono::duration<double, std::milli>(rtt).count();
+
+        if (!hasSample) {
+            srtt = sample;
+            rttvar = sample / 2.0;
+            hasSample = true;
+        } else {
+            rttvar = (1.0 - beta) * rttvar + beta * std::abs(srtt - sample);
+            srtt = (1.0 - alpha) * srtt + alpha * sample;
+        }
+        minRtt = std::min(minRtt, sample);
+        lastRtt = sample;
+
+        currentRto = clampRto(srtt + std::max(granularityMs, 4.0 * rttvar));
+    }
+
+    // Timeout expirou: backoff exponencial
+    void backoff() {
+        currentRto = clampRto(currentRto * 2.0);
+    }
+
+    [[nodiscard]] int rtoMs() const { return static_cast<int>(std::lround(currentRto)); }
+    [[nodiscard]] double smoothedRttMs() const { return hasSample ? srtt : 0.0; }
+    [[nodiscard]] double rttVarianceMs() const { return hasSample ? rttvar : 0.0; }
+    [[nodiscard]] double minRttMs() const { return hasSample ? minRtt : 0.0; }
+    [[nodiscard]] double lastRttMs() const { return hasSample ? lastRtt : 0.0; }
+    [[nodiscard]] bool hasEstimate() const { return hasSample; }
+
+private:
+    static constexpr double alpha = 1.0 / 8.0;
+    static constexpr double beta = 1.0 / 4.0;
+    static constexpr double granularityMs = 1.0;
+
+    bool hasSample{false};
+    double srtt{0.0};
+    double rttvar{0.0};
+    double minRtt{1e9};
+    double lastRtt{0.0};
+    double currentRto{CHROMA_INITIAL_RTO_MS};
+
+    static double clampRto(double rto) {
+        return std::clamp(rto, static_cast<double>(CHROMA_MIN_RTO_MS),
+                          static_cast<double>(CHROMA_MAX_RTO_MS));
+    }
+};
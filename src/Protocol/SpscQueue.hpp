@@ -0,0 +1,63 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <new>
+#include <utility>
+#include <vector>
+
+// Fila circular sem trava para exatamente um produtor e um consumidor. A
+// capacidade é arredondada para potência de dois; head e tail ficam em linhas
+// de cache separadas para as duas threads não disputarem a mesma linha.
+template <typename T>
+class SpscQueue {
+public:
+    explicit SpscQueue(size_t minCapacity)
+        : slots(std::bit_ceil(std::max<size_t>(minCapacity, 2))), mask(slots.size() - 1) {}
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    // Só o produtor chama
+    bool push(T value) {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if (t - headCache == slots.size()) {
+            headCache = head.load(std::memory_order_acquire);
+            if (t - headCache == slots.size()) return false;
+        }
+        slots[t & mask] = std::move(value);
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Só o consumidor chama
+    bool pop(T& out) {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (h == tailCache) {
+            tailCache = tail.load(std::memory_order_acquire);
+            if (h == tailCache) return false;
+        }
+        out = std::move(slots[h & mask]);
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Aproximado quando lido pela outra ponta
+    [[nodiscard]] size_t size() const {
+        return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire);
+    }
+    [[nodiscard]] size_t capacity() const { return slots.size(); }
+
+private:
+    static constexpr size_t CACHE_LINE = 64;
+
+    std::vector<T> slots;
+    size_t mask;
+
+    alignas(CACHE_LINE) std::atomic<size_t> head{0};
+    size_t tailCache{0};   // cópia do consumidor
+    alignas(CACHE_LINE) std::atomic<size_t> tail{0};
+    size_t headCache{0};   // cópia do produtor
+};
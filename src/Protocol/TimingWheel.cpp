@@ -0,0 +1,199 @@
+#include "TimingWheel.hpp"
+
+#include <algorithm>
+#include <bit>
+
+TimingWheel::TimingWheel(size_t initialCapacity) : epoch(Clock::now()) {
+    for (auto& level : heads) level.fill(NIL);
+
+    // Pool inicial já encadeado na free list; só cresce se houver mais
+    // timers pendentes ao mesmo tempo do que nunca houve
+    nodes.resize(std::max<size_t>(initialCapacity, 1));
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        nodes[i].next = (i + 1 < nodes.size()) ? static_cast<uint32_t>(i + 1) : NIL;
+    }
+    freeList = 0;
+    expired.reserve(256);
+}
+
+TimingWheel::Handle TimingWheel::schedule(uint32_t delayMs, Callback cb, void* ctx, uint64_t arg) {
+    return schedule(delayMs, cb, ctx, arg, Clock::now());
+}
+
+TimingWheel::Handle TimingWheel::schedule(uint32_t delayMs, Callback cb, void* ctx, uint64_t arg, TimePoint now) {
+    uint32_t idx = allocNode();
+    Node& node = nodes[idx];
+    node.cb = cb;
+    node.ctx = ctx;
+    node.arg = arg;
+    node.expiry = std::max(toTick(now), currentTick)
+                + std::clamp<uint64_t>(delayMs, 1, MAX_DELAY);
+    link(idx);
+    armedCount++;
+
+    return (static_cast<uint64_t>(node.generation) << 32) | idx;
+}
+
+bool TimingWheel::cancel(Handle handle) {
+    if (handle == NO_TIMER) return false;
+    uint32_t idx = static_cast<uint32_t>(handle);
+    uint32_t generation = static_cast<uint32_t>(handle >> 32);
+    if (idx >= nodes.size() || nodes[idx].generation != generation || !nodes[idx].armed) {
+        return false;
+    }
+    unlink(idx);
+    releaseNode(idx);
+    return true;
+}
+
+size_t TimingWheel::advance(TimePoint now) {
+    // Exceção de um callback sobe até quem chamou (é bug, não é engolida);
+    // o que ela deixou na lista não pode disparar de novo na próxima chamada
+    expired.clear();
+    collect(toTick(now));
+
+    // Os callbacks podem rearmar/cancelar timers: a lista de vencidos já
+    // está fechada e cada entrada é copiada antes da chamada
+    size_t fired = 0;
+    for (; fired < expired.size(); ++fired) {
+        Expired e = expired[fired];
+        e.cb(e.ctx, e.arg);
+    }
+    expired.clear();
+    return fired;
+}
+
+size_t TimingWheel::pending() const {
+    return armedCount;
+}
+
+TimingWheel::TimePoint TimingWheel::nextDeadline() const {
+    uint64_t next = nextEventTick();
+    return next == UINT64_MAX ? TimePoint::max() : toTime(next);
+}
+
+uint64_t TimingWheel::toTick(TimePoint t) const {
+    if (t <= epoch) return 0;
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(t - epoch).count());
+}
+
+TimingWheel::TimePoint TimingWheel::toTime(uint64_t tick) const {
+    return epoch + std::chrono::milliseconds(tick);
+}
+
+uint32_t TimingWheel::allocNode() {
+    if (freeList == NIL) {
+        nodes.emplace_back();
+        return static_cast<uint32_t>(nodes.size() - 1);
+    }
+    uint32_t idx = freeList;
+    freeList = nodes[idx].next;
+    return idx;
+}
+
+void TimingWheel::releaseNode(uint32_t idx) {
+    Node& node = nodes[idx];
+    node.armed = false;
+    if (++node.generation == 0) node.generation = 1;   // handle 0 é reservado
+    node.next = freeList;
+    freeList = idx;
+    armedCount--;
+}
+
+// O nível é o mais baixo em que expiry e currentTick só diferem nos dígitos
+// daquele nível para baixo; assim todo nó no nível l está na volta corrente
+// e desce um nível quando a roda de cima gira até o seu slot.
+void TimingWheel::link(uint32_t idx) {
+    Node& node = nodes[idx];
+    uint64_t expiry = std::max(node.expiry, currentTick);
+
+    uint32_t level = 0;
+    uint64_t diff = expiry ^ currentTick;
+    while (level + 1 < LEVELS && (diff >> (SLOT_BITS * (level + 1))) != 0) {
+        level++;
+    }
+    uint32_t slot = static_cast<uint32_t>(expiry >> (SLOT_BITS * level)) & (SLOTS - 1);
+
+    node.level = static_cast<uint8_t>(level);
+    node.slot = static_cast<uint8_t>(slot);
+    node.prev = NIL;
+    node.next = heads[level][slot];
+    if (node.next != NIL) nodes[node.next].prev = idx;
+    heads[level][slot] = idx;
+    occupied[level] |= uint64_t{1} << slot;
+    node.armed = true;
+}
+
+void TimingWheel::unlink(uint32_t idx) {
+    Node& node = nodes[idx];
+    if (node.prev != NIL) {
+        nodes[node.prev].next = node.next;
+    } else {
+        heads[node.level][node.slot] = node.next;
+        if (node.next == NIL) occupied[node.level] &= ~(uint64_t{1} << node.slot);
+    }
+    if (node.next != NIL) nodes[node.next].prev = node.prev;
+    node.armed = false;
+}
+
+void TimingWheel::cascade(uint32_t level) {
+    uint32_t slot = static_cast<uint32_t>(currentTick >> (SLOT_BITS * level)) & (SLOTS - 1);
+    uint32_t idx = heads[level][slot];
+    heads[level][slot] = NIL;
+    occupied[level] &= ~(uint64_t{1} << slot);
+
+    while (idx != NIL) {
+        uint32_t next = nodes[idx].next;
+        link(idx);
+        idx = next;
+    }
+}
+
+void TimingWheel::collect(uint64_t untilTick) {
+    while (currentTick < untilTick) {
+        if (armedCount == 0) {
+            currentTick = untilTick;
+            break;
+        }
+        // Nível 0 vazio: pula direto para o fim da volta, onde há cascata
+        if (occupied[0] == 0) {
+            currentTick = std::min(untilTick, currentTick | (SLOTS - 1));
+            if (currentTick == untilTick) break;
+        }
+
+        currentTick++;
+        for (uint32_t level = LEVELS - 1; level > 0; --level) {
+            uint64_t lowBits = (uint64_t{1} << (SLOT_BITS * level)) - 1;
+            if ((currentTick & lowBits) == 0) cascade(level);
+        }
+
+        uint32_t slot = static_cast<uint32_t>(currentTick) & (SLOTS - 1);
+        uint32_t idx = heads[0][slot];
+        heads[0][slot] = NIL;
+        occupied[0] &= ~(uint64_t{1} << slot);
+
+        while (idx != NIL) {
+            Node& node = nodes[idx];
+            uint32_t next = node.next;
+            if (node.expiry > currentTick) {
+                link(idx);   // além do alcance do nível mais alto: volta para a roda
+            } else {
+                expired.push_back({node.cb, node.ctx, node.arg});
+                releaseNode(idx);
+            }
+            idx = next;
+        }
+    }
+}
+
+uint64_t TimingWheel::nextEventTick() const {
+    if (armedCount == 0) return UINT64_MAX;
+
+    uint32_t slot = static_cast<uint32_t>(currentTick) & (SLOTS - 1);
+    uint64_t ahead = (slot == SLOTS - 1) ? 0 : occupied[0] & (~uint64_t{0} << (slot + 1));
+    if (ahead != 0) {
+        return (currentTick & ~uint64_t{SLOTS - 1}) + static_cast<uint64_t>(std::countr_zero(ahead));
+    }
+    // Nada no nível 0 nesta volta: acorda na próxima cascata
+    return (currentTick | (SLOTS - 1)) + 1;
+}
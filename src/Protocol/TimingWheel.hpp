@@ -0,0 +1,96 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+// Roda de timers hierárquica (4 níveis de 64 slots, tick de 1 ms). Armar e
+// cancelar são O(1): cada timer é um nó de um pool pré-alocado, encadeado por
+// índice na lista do seu slot, e o handle carrega a geração do nó, de modo
+// que cancelar um handle velho (nó já disparado e reaproveitado) não tem
+// efeito. O callback é um ponteiro de função + contexto + argumento, sem
+// std::function nem alocação por timer.
+//
+// Sem travas: a roda pertence a uma thread (a do Reactor), que arma, cancela
+// e dispara. Como os callbacks rodam nessa mesma thread, cancelar os timers
+// de um contexto basta para nenhum disparar depois dele ser destruído.
+class TimingWheel {
+public:
+    using Clock     = std::chrono::steady_clock;
+    using TimePoint = Clock::time_point;
+    using Callback  = void (*)(void* ctx, uint64_t arg);
+    using Handle    = uint64_t;   // (geração << 32) | índice; 0 = nenhum timer
+
+    static constexpr Handle NO_TIMER = 0;
+
+    explicit TimingWheel(size_t initialCapacity = 1024);
+
+    TimingWheel(const TimingWheel&) = delete;
+    TimingWheel& operator=(const TimingWheel&) = delete;
+
+    // Agenda `cb(ctx, arg)` para daqui a `delayMs` (mínimo de 1 tick)
+    Handle schedule(uint32_t delayMs, Callback cb, void* ctx, uint64_t arg);
+    Handle schedule(uint32_t delayMs, Callback cb, void* ctx, uint64_t arg, TimePoint now);
+
+    // Remove o timer se ainda não disparou; handles velhos são ignorados.
+    // Pode ser chamado de dentro de um callback.
+    bool cancel(Handle handle);
+
+    // Dispara tudo que venceu até `now`. Exceção de um callback não é
+    // capturada: sobe para o loop do reactor (e encerra o shard).
+    size_t advance(TimePoint now);
+
+    [[nodiscard]] size_t pending() const;
+
+    // Instante em que advance() tem trabalho (disparo ou cascata);
+    // TimePoint::max() se não há timers. Usado para armar um timerfd.
+    [[nodiscard]] TimePoint nextDeadline() const;
+
+private:
+    static constexpr uint32_t LEVELS = 4;
+    static constexpr uint32_t SLOT_BITS = 6;
+    static constexpr uint32_t SLOTS = 1U << SLOT_BITS;
+    static constexpr uint32_t NIL = UINT32_MAX;
+    static constexpr uint64_t MAX_DELAY = (uint64_t{1} << (SLOT_BITS * LEVELS)) - 1;
+
+    struct Node {
+        uint64_t expiry{0};
+        uint32_t next{NIL};
+        uint32_t prev{NIL};
+        uint32_t generation{1};
+        uint8_t level{0};
+        uint8_t slot{0};
+        bool armed{false};
+        Callback cb{nullptr};
+        void* ctx{nullptr};
+        uint64_t arg{0};
+    };
+
+    struct Expired {
+        Callback cb;
+        void* ctx;
+        uint64_t arg;
+    };
+
+    std::vector<Node> nodes;
+    uint32_t freeList{NIL};
+    std::array<std::array<uint32_t, SLOTS>, LEVELS> heads;
+    std::array<uint64_t, LEVELS> occupied{};   // bitmap de slots não vazios por nível
+    std::vector<Expired> expired;              // reaproveitado entre disparos
+
+    TimePoint epoch;
+    uint64_t currentTick{0};
+    size_t armedCount{0};
+
+    [[nodiscard]] uint64_t toTick(TimePoint t) const;
+    [[nodiscard]] TimePoint toTime(uint64_t tick) const;
+
+    uint32_t allocNode();
+    void releaseNode(uint32_t idx);
+    void link(uint32_t idx);
+    void unlink(uint32_t idx);
+    void cascade(uint32_t level);
+    void collect(uint64_t untilTick);
+    [[nodiscard]] uint64_t nextEventTick() const;
+};
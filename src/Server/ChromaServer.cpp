@@ -1,8 +1,10 @@
 #include "ChromaServer.hpp"
 #include <fstream>
 #include <fcntl.h>
+#include <algorithm>
 #include <cmath>
 #include <iostream>
+#include <netinet/ip.h>
 
 using namespace std;
 
@@ -15,8 +17,9 @@ using namespace std;
 #define MAGENTA "\033[35m"
 #define RESET   "\033[0m"
 
-ChromaServer::ChromaServer(int winSize, const sockaddr_in& clientAddr)
-    : ChromaProtocol(winSize), clientAddr(clientAddr), scheduler()
+ChromaServer::ChromaServer(Reactor& reactor, int winSize, const sockaddr_in& clientAddr, const std::string& ccAlgorithm)
+    : ChromaProtocol(winSize), reactor(reactor), clientAddr(clientAddr), scheduler(reactor.timers()),
+      congestion(makeCongestionController(ccAlgorithm))
 {
     addr.sin_family = AF_INET;
     addr.sin_addr.s_addr = INADDR_ANY;
@@ -43,18 +46,21 @@ ChromaServer::ChromaServer(int winSize, const sockaddr_in& clientAddr)
 ChromaServer::~ChromaServer() {
     cout << CYAN << "[ChromaServer] Encerrando servidor, limpando timers..."
          << RESET << "\n";
-    scheduler.stop();
+
+    // A roda é do reactor e continua viva: nada desta sessão pode ficar armado
+    cancelTimers();
+    if (readAhead) readAhead->cancel();
+    if (state != State::Finished) {
+        reactor.remove(sockfd);
+    }
 }
 
 void ChromaServer::sendData(const char* filename, size_t chunkSize) {
-    if (chunkSize == 0 || chunkSize > CHROMA_MAX_DATA) {
-        cerr << YELLOW << "[ChromaServer] chunkSize inválido. Ajustando para "
-             << CHROMA_MAX_DATA << RESET << "\n";
-        chunkSize = CHROMA_MAX_DATA;
-    }
+    requestedChunk = chunkSize;
+    fileName = filename;
 
-    ifstream file(filename, ios::in | ios::binary);
-    if (!file.is_open()) {
+    file = FileCache::instance().acquire(filename);
+    if (!file) {
         std::string errMsg = "erro ao abrir arquivo com nome incorreto ou inexistente";
         std::vector<char> errMsgVec(errMsg.begin(), errMsg.end());
 
@@ -62,128 +68,769 @@ void ChromaServer::sendData(const char* filename, size_t chunkSize) {
         sendPacket(nack, clientAddr);
 
         cerr << RED << "[ChromaServer] " << errMsg << RESET << "\n";
+        finish(false);
         return;
     }
 
-    Packet meta = makeMetaDataPacket(filename, file, chunkSize);
-    sendPacket(meta, clientAddr);
+    sourceVersion = file->version();
+    prepare();
+}
 
-    if (!waitResponse(5)) {
-        cerr << RED << "[ChromaServer] Timeout aguardando ACK de metadados."
-             << RESET << "\n";
+// Assinatura e árvore de Merkle saem do HashPool: até ficarem prontas a
+// sessão fica em Preparing, sem bloquear o reactor, e consulta de novo a
+// cada CHROMA_PREPARE_POLL_MS. Cálculo que falhou ou passou do prazo
+// encerra a sessão com NACK e libera o lugar na admissão.
+void ChromaServer::prepare() {
+    if (resolveSource()) {
+        startTransfer();
+        return;
+    }
+    if (sourceFailed()) {
+        abortSession("falha ao preparar o arquivo no servidor");
         return;
     }
 
-    Packet ackMeta;
-    if (recvPacket(ackMeta) <= 0 || ackMeta.flag != ChromaFlag::ACK || isCorrupted(ackMeta)) {
-        cerr << RED << "[ChromaServer] Falha ao receber ACK válido de metadados."
-             << RESET << "\n";
+    auto now = RttEstimator::Clock::now();
+    if (state != State::Preparing) {
+        state = State::Preparing;
+        prepareDeadline = now + std::chrono::milliseconds(CHROMA_PREPARE_TIMEOUT_MS);
+        cout << CYAN << "[ChromaServer] Preparando " << fileName << RESET << "\n";
+        sendPreparing();
+    } else if (now >= prepareDeadline) {
+        abortSession("arquivo ainda em preparação no servidor, tente mais tarde");
         return;
     }
+    prepareTimer = scheduler.schedule(CHROMA_PREPARE_POLL_MS, [](void* self, uint64_t) {
+        auto* server = static_cast<ChromaServer*>(self);
+        server->prepareTimer = TimingWheel::NO_TIMER;
+        server->prepare();
+    }, this, 0);
+}
 
-    bool finishedReading = false;
-    while (!finishedReading || !bufferPackets.empty()) {
-        while ((uint8_t)(nextSeqNum - base) < windowSize && !finishedReading) {
-            vector<char> buffer(chunkSize);
-            file.read(buffer.data(), chunkSize);
-            streamsize bytesRead = file.gcount();
-
-            if (bytesRead > 0) {
-                Packet pkt(static_cast<uint8_t>(nextSeqNum),
-                           std::vector<char>(buffer.begin(), buffer.begin() + bytesRead),
-                           ChromaFlag::DATA, addr);
-                {
-                    std::lock_guard<std::mutex> lock(m_mutex);
-                    bufferPackets[pkt.seqNum] = pkt;
-                }
+// Troca o arquivo pelo que a sessão serve de fato; false enquanto falta algo
+bool ChromaServer::resolveSource() {
+    if (merkleRootRequested || merkleLeavesRequested) {
+        std::shared_ptr<const MerkleTree> tree = file->merkleTree();
+        if (!tree) return false;
+        merkleRoot = MerkleTree::toHex(tree->root);
+    }
+    if (merkleLeavesRequested) {
+        file = file->merkleLeaves();
+    } else if (signatureBlock > 0) {
+        // Delta sync: em vez do arquivo, a sessão serve a assinatura dos blocos dele
+        std::shared_ptr<const FileCache::MappedFile> signature = file->signature();
+        if (!signature) return false;
+        file = std::move(signature);
+        cout << CYAN << "[ChromaServer] Assinatura de " << fileName << " (blocos de "
+             << signatureBlock << " bytes): " << file->size() << " bytes" << RESET << "\n";
+    }
+    return true;
+}
 
-                cout << GREEN << "[ChromaServer] Enviando pacote "
-                     << static_cast<int>(pkt.seqNum)
-                     << " (" << bytesRead << " bytes)"
-                     << RESET << "\n";
+// O que resolveSource() espera não vai ficar pronto
+bool ChromaServer::sourceFailed() const {
+    if ((merkleRootRequested || merkleLeavesRequested) && file->merkleTreeFailed()) return true;
+    return !merkleLeavesRequested && signatureBlock > 0 && file->signatureFailed();
+}
 
-                setTimerAndSendPacket(pkt, 200, clientAddr);
-                nextSeqNum++;
-            }
+// O cliente trata como fila: repete o GET a cada "retry" até o META chegar
+void ChromaServer::sendPreparing() {
+    std::vector<char> payload;
+    appendOption(payload, "retry", to_string(CHROMA_QUEUE_KEEPALIVE_MS));
+    appendOption(payload, "queued", "0");
+    sendPacket(0, ChromaFlag::BUSY, payload, clientAddr);
+}
+
+void ChromaServer::startTransfer() {
+    // Trecho pedido fora do arquivo fica vazio: só META e END
+    rangeStart = std::min<uint64_t>(rangeOffset, file->size());
+    rangeEnd = rangeStart + std::min<uint64_t>(rangeLength, file->size() - rangeStart);
+    fileOffset = rangeStart;
+
+    FileCache::Stats cache = FileCache::instance().stats();
+    cout << CYAN << "[ChromaServer] Cache de arquivos: " << cache.hits << " hits, "
+         << cache.misses << " misses, " << cache.entries << " arquivos ("
+         << cache.cachedBytes / (1024 * 1024) << " MB)" << RESET << "\n";
+
+    if (!startProbing()) {
+        sendMeta();
+    }
+}
+
+void ChromaServer::sendMeta() {
+    // O chunk sai do maior datagrama que o caminho aceitou (cabeçalho largo
+    // no pior caso), limitado ao que quem criou a sessão pediu
+    size_t pathChunk = pathDatagram - CHROMA_MAX_HEADER_SIZE;
+    if (fecBlock > 0) {
+        pathChunk -= CHROMA_FEC_OVERHEAD;   // a paridade leva cabeçalho e o símbolo do chunk
+    }
+    chunkSize = requestedChunk == 0 ? pathChunk : std::min(requestedChunk, pathChunk);
+    if (fecBlock > 0) {
+        fecEncoder = FecEncoder(chunkSize);
+    }
 
-            if (file.eof()) finishedReading = true;
+    // A leitura antecipada começa já: o disco trabalha durante o handshake
+    if (prefetcher && readAheadChunks > 0 && rangeEnd > rangeStart) {
+        readAhead = std::make_shared<ReadAheadStream>(file, chunkSize, readAheadChunks, rangeStart, rangeEnd);
+        prefetcher->request(readAhead);
+    }
+
+    offeredCodec = codecOffer.empty() ? nullptr : Codec::choose(codecOffer);
+    metaPacket = makeMetaDataPacket(fileName, file->size(), chunkSize);
+    sendPacket(metaPacket, clientAddr);
+
+    state = State::AwaitingMetaAck;
+    armMetaTimer();
+}
+
+namespace {
+// Maior payload UDP que a interface de saída para o cliente comporta
+size_t localDatagramLimit(const sockaddr_in& dest) {
+    int probe = ::socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    if (probe < 0) return UDP_MAX_PAYLOAD;
+
+    size_t limit = UDP_MAX_PAYLOAD;
+    int mtu = 0;
+    socklen_t len = sizeof(mtu);
+    if (connect(probe, reinterpret_cast<const sockaddr*>(&dest), sizeof(dest)) == 0 &&
+        getsockopt(probe, IPPROTO_IP, IP_MTU, &mtu, &len) == 0 && mtu > 28) {
+        limit = static_cast<size_t>(mtu) - 28;   // IP + UDP
+    }
+    close(probe);
+    return limit;
+}
+}
+
+bool ChromaServer::startProbing() {
+    size_t limit = std::min({peerMaxDatagram, localDatagramLimit(clientAddr), CHROMA_OFFLOAD_MAX_BYTES});
+
+    // Candidatos: o máximo da interface (loopback chega a 64 KiB) e jumbo frame
+    probeSizes.clear();
+    for (size_t size : {limit, CHROMA_JUMBO_DATAGRAM}) {
+        if (size > UDP_MAX_PAYLOAD && size <= limit &&
+            std::find(probeSizes.begin(), probeSizes.end(), size) == probeSizes.end()) {
+            probeSizes.push_back(size);
         }
+    }
+    if (probeSizes.empty()) return false;
 
-        receiveData();
+    // DF ligado e PMTU em cache ignorada: sonda grande demais se perde no
+    // caminho em vez de ser fragmentada
+    int mode = IP_PMTUDISC_PROBE;
+    if (setsockopt(sockfd, IPPROTO_IP, IP_MTU_DISCOVER, &mode, sizeof(mode)) < 0) {
+        return false;
     }
 
-    file.close();
+    probePadding.assign(probeSizes.front() - CHROMA_HEADER_SIZE, 0);
+    state = State::Probing;
+    sendProbes();
+    return true;
+}
 
-    // Pacote final com flag de encerramento
-    Packet endPkt(0, {}, ChromaFlag::END, addr);
-    sendPacket(endPkt, clientAddr);
-    cout << BLUE << "[ChromaServer] Arquivo enviado com sucesso!" 
+void ChromaServer::sendProbes() {
+    probeRounds++;
+    for (size_t i = 0; i < probeSizes.size(); ++i) {
+        if (probeSizes[i] <= pathDatagram) continue;   // já temos um maior confirmado
+        std::span<const char> padding(probePadding.data(), probeSizes[i] - CHROMA_HEADER_SIZE);
+        sendPacket(static_cast<uint32_t>(i), ChromaFlag::PROBE, padding, clientAddr);
+    }
+
+    scheduler.cancel(probeTimer);
+    probeTimer = scheduler.schedule(CHROMA_PROBE_INTERVAL_MS, [](void* self, uint64_t) {
+        auto* server = static_cast<ChromaServer*>(self);
+        server->probeTimer = TimingWheel::NO_TIMER;
+        if (server->probeRounds < CHROMA_MAX_PROBES) {
+            server->sendProbes();
+        } else {
+            server->finishProbing();
+        }
+    }, this, 0);
+}
+
+void ChromaServer::handleProbeAck(const PacketView& pkt) {
+    if (pkt.flag != ChromaFlag::PROBE || pkt.seqNum >= probeSizes.size()) return;
+
+    pathDatagram = std::max(pathDatagram, probeSizes[pkt.seqNum]);
+    if (pathDatagram == probeSizes.front()) {
+        finishProbing();   // o maior candidato passou: nada a ganhar esperando
+    }
+}
+
+void ChromaServer::finishProbing() {
+    scheduler.cancel(probeTimer);
+    probeTimer = TimingWheel::NO_TIMER;
+    probePadding = {};
+
+    cout << CYAN << "[ChromaServer] PMTU: datagramas de " << pathDatagram << " bytes"
          << RESET << "\n";
+    if (pathDatagram > UDP_MAX_PAYLOAD) {
+        // Uma janela de datagramas grandes não cabe no buffer padrão do socket
+        growSocketBuffer(SO_SNDBUF, SO_SNDBUFFORCE, CHROMA_BULK_SOCKET_BUFFER);
+    }
+    sendMeta();
 }
 
-void ChromaServer::receiveData() {
-    Packet pkt;
+void ChromaServer::resendMeta() {
+    if (state == State::Preparing) {
+        sendPreparing();
+        return;
+    }
+    if (state != State::AwaitingMetaAck) return;
+
+    cout << CYAN << "[ChromaServer] Reenviando META" << RESET << "\n";
+    sendPacket(metaPacket, clientAddr);
+    armMetaTimer();
+}
+
+void ChromaServer::armMetaTimer() {
+    scheduler.cancel(metaTimer);
+    metaTimer = scheduler.schedule(CHROMA_META_TIMEOUT_MS, [](void* self, uint64_t) {
+        auto* server = static_cast<ChromaServer*>(self);
+        server->metaTimer = TimingWheel::NO_TIMER;
+        cerr << RED << "[ChromaServer] Timeout aguardando ACK de metadados."
+             << RESET << "\n";
+        server->finish(false);
+    }, this, 0);
+}
+
+void ChromaServer::onEvent(uint32_t) {
+    receiveData();
+}
+
+void ChromaServer::handleMetaAck(const PacketView& pkt) {
+    if (pkt.flag != ChromaFlag::ACK) return;
+
+    scheduler.cancel(metaTimer);
+    metaTimer = TimingWheel::NO_TIMER;
+
+    negotiateWireVersion(pkt);
+    bufferPackets.reset(windowSize, 0);   // payloads apontam para o arquivo mapeado
+
+    // Compressão só vale se o cliente repetiu no ACK o codec do META
+    Options options = parseOptions(pkt.data, 0);
+    if (offeredCodec && options["comp"] == offeredCodec->name()) {
+        codec = offeredCodec;
+        compressed.assign(bufferPackets.capacity(), {});
+        cout << CYAN << "[ChromaServer] Compressão " << codec->name() << " por chunk" << RESET << "\n";
+    }
+    if (fecBlock > 0) {
+        fecCover.assign(bufferPackets.capacity(), {});
+        cout << CYAN << "[ChromaServer] FEC em blocos de " << fecBlock << " pacotes (até "
+             << fecMaxParity << " paridades)" << RESET << "\n";
+    }
+    burst.reserve(windowSize);
+    state = State::Transferring;
+}
+
+void ChromaServer::pump() {
+    if (state != State::Transferring) return;
+
+    burst.clear();
+    parityUsed = 0;
+
+    // Quantos pacotes podem sair agora: janela negociada, janela de
+    // congestionamento e orçamento do pacer
+    auto now = RttEstimator::Clock::now();
+    uint32_t window = dataWindow();
+    uint32_t inFlight = getSeqDistance(base, nextSeqNum);
+    uint32_t budget = inFlight < window ? window - inFlight : 0;
+    bool windowOpen = budget > 0;
+    bool diskStalled = false;
+    // O pacer conta a rajada inteira, paridades incluídas
+    uint32_t allowance = pacer.allowance(now);
+
+    while (budget > 0 && burst.size() < allowance && !finishedReading) {
+        // O slot aponta direto para as páginas do arquivo em cache: nada é copiado
+        std::span<const char> chunk;
+        if (readAhead) {
+            if (!readAhead->next(chunk)) {
+                diskStalled = true;   // o worker ainda não trouxe o próximo chunk
+                break;
+            }
+        } else {
+            chunk = file->chunk(fileOffset, std::min<uint64_t>(chunkSize, rangeEnd - fileOffset));
+        }
+        if (chunk.empty() || fileOffset >= rangeEnd) {
+            finishedReading = true;
+            break;
+        }
+
+        PacketRing::Slot* slot = attachChunk(nextSeqNum, chunk);
+        slot->sentAt = now;
+        slot->transmissions = 1;
+        slot->rtoMs = rtt.rtoMs();
+
+        cout << GREEN << "[ChromaServer] Enviando pacote "
+             << slot->seqNum
+             << " (" << chunk.size() << " bytes)"
+             << RESET << "\n";
+
+        armRetransmitTimer(*slot);
+        burst.emplace_back(*slot);
+        if (fecBlock > 0) protect(*slot, now);
+        nextSeqNum = nextSeq(nextSeqNum);
+        fileOffset += chunk.size();
+        budget--;
+
+        if (fileOffset >= rangeEnd) finishedReading = true;
+    }
 
-    while (true) {
-        int r = recvPacket(pkt);
-        if (r <= 0) break; 
+    // Sem janela para completar o bloco de FEC, ele fecha agora: esperar o
+    // resto seguraria a paridade justamente quando há buraco. Limitado só
+    // pelo pacer ou pelo disco, o bloco continua na próxima rodada.
+    if (fecEncoder.open() && (finishedReading || getSeqDistance(base, nextSeqNum) >= window)) {
+        closeFecBlock(now);
+    }
 
-        if (isCorrupted(pkt)) {
-            cerr << RED << "[ChromaServer] Pacote corrompido ignorado."
+    // O que a janela liberou sai em um único sendmmsg (ou poucos, se maior que o lote)
+    if (!burst.empty()) {
+        if (sendBatch(burst, clientAddr) < static_cast<int>(burst.size())) {
+            file->checkTruncated();
+        }
+        pacer.consume(static_cast<uint32_t>(burst.size()));
+    }
+    if (abortIfTruncated()) return;
+
+    if (finishedReading && bufferPackets.empty()) {
+        // Pacote final com flag de encerramento
+        Packet endPkt(0, {}, ChromaFlag::END, addr);
+        sendPacket(endPkt, clientAddr);
+        cout << BLUE << "[ChromaServer] Arquivo enviado com sucesso!" 
+             << RESET << "\n";
+        if (codec && rawBytesSent > 0) {
+            cout << BLUE << "[ChromaServer] " << codec->name() << ": " << rawBytesSent << " -> "
+                 << wireBytesSent << " bytes (" << 100.0 * wireBytesSent / rawBytesSent << "%)"
                  << RESET << "\n";
-            continue;
         }
+        if (fecBlock > 0) {
+            cout << BLUE << "[ChromaServer] FEC: " << paritySent << " paridades, " << fecRecovered
+                 << " pacotes reconstruídos no cliente, " << retransmissions << " retransmissões (perda estimada "
+                 << 100.0 * lossRate << "%)" << RESET << "\n";
+        }
+        cout << BLUE << "[ChromaServer] RTT suavizado " << rtt.smoothedRttMs()
+             << " ms (var " << rtt.rttVarianceMs() << " ms, RTO " << rtt.rtoMs() << " ms)"
+             << " | " << congestion->name() << " cwnd " << congestion->window()
+             << RESET << "\n";
+        finish(true);
+        return;
+    }
 
-        if (pkt.flag == ChromaFlag::ACK) {
-            std::lock_guard<std::mutex> lock(m_mutex);
+    if (readAhead && readAhead->wantsMore()) {
+        prefetcher->request(readAhead);
+    }
 
-            uint8_t seq = pkt.seqNum;
-            cerr << YELLOW << "[ChromaServer] ACK recebido para seq "
-                << (int)seq << RESET << "\n";
+    // Read-ahead atrasado: tenta de novo no próximo tick. Janela com folga mas
+    // pacer sem tokens: volta quando ele liberar. Com a janela cheia quem
+    // chama pump() de novo é a chegada de ACKs.
+    if (diskStalled) {
+        schedulePump(1);
+    } else if (windowOpen && !finishedReading && getSeqDistance(base, nextSeqNum) < window) {
+        auto wait = pacer.timeUntilNext(RttEstimator::Clock::now());
+        auto waitMs = std::max<int64_t>(1, std::chrono::ceil<std::chrono::milliseconds>(wait).count());
+        schedulePump(static_cast<uint32_t>(waitMs));
+    }
+}
+
+// Chunk que encolhe vai comprimido (ZDATA) num buffer do slot; o resto, e
+// tudo quando não há codec, continua apontando para o arquivo mapeado
+PacketRing::Slot* ChromaServer::attachChunk(uint32_t seq, std::span<const char> chunk) {
+    rawBytesSent += chunk.size();
+    if (codec && looksCompressible(chunk)) {
+        std::vector<char>& buffer = compressed[seq % compressed.size()];
+        buffer.resize(chunk.size() - 1);   // precisa ganhar pelo menos um byte
+        size_t length = codec->compress(chunk, buffer);
+        if (length > 0) {
+            wireBytesSent += length;
+            return &bufferPackets.attach(seq, ChromaFlag::ZDATA, {buffer.data(), length});
+        }
+    }
+    wireBytesSent += chunk.size();
+    return &bufferPackets.attach(seq, ChromaFlag::DATA, chunk);
+}
+
+void ChromaServer::protect(const PacketRing::Slot& slot, RttEstimator::Clock::time_point now) {
+    if (!fecEncoder.open()) {
+        fecEncoder.begin(packetIndex, fecBlock, parityFor(fecBlock));
+        fecBlockSeq = slot.seqNum;
+    }
+    packetIndex++;
+
+    // Até a paridade sair, um buraco neste pacote não é retransmitido às pressas
+    fecCover[slot.seqNum % fecCover.size()] = fecEncoder.parityCount() > 0
+        ? RttEstimator::Clock::time_point::max() : RttEstimator::Clock::time_point{};
+    if (fecEncoder.add(slot.flag, slot.data())) {
+        closeFecBlock(now);
+    }
+}
 
-            scheduler.cancel(seq);   
-            size_t erased = bufferPackets.erase(seq);
+// Fecha o bloco e põe as paridades na rajada, logo depois dos pacotes dele.
+// O encoder é reaberto pelo próximo bloco, então a rajada fica com cópias.
+void ChromaServer::closeFecBlock(RttEstimator::Clock::time_point now) {
+    fecEncoder.close();
+    uint32_t rows = std::min(fecEncoder.parityCount(), parityFor(fecEncoder.size()));
+
+    for (uint32_t row = 0; row < rows; ++row) {
+        if (parityUsed == parityPackets.size()) parityPackets.emplace_back();
+        std::vector<char>& packet = parityPackets[parityUsed++];
+        std::span<const char> parity = fecEncoder.packet(row);
+        packet.assign(parity.begin(), parity.end());
+        burst.emplace_back(fecBlockSeq, ChromaFlag::FEC, packet);
+    }
+    paritySent += rows;
 
-            uint8_t oldBase = base;
-            while (base != nextSeqNum && bufferPackets.find(base) == bufferPackets.end()) {
-                base = static_cast<uint8_t>((base + 1) % 256);
+    auto sentAt = rows > 0 ? now : RttEstimator::Clock::time_point{};
+    for (uint32_t i = 0, seq = fecBlockSeq; i < fecEncoder.size(); ++i, seq = nextSeq(seq)) {
+        fecCover[seq % fecCover.size()] = sentAt;
+    }
+}
+
+// A paridade ocupa a rede como os DATA, mas não tem seq nem ACK e não
+// aparece no que está em voo: a cwnd reserva para ela a fração que ela
+// representa em cada bloco, e os DATA ficam com o resto
+uint32_t ChromaServer::dataWindow() const {
+    uint32_t window = std::min(windowSize, congestion->window());
+    if (fecBlock == 0) return window;
+
+    uint32_t parity = parityFor(fecBlock);
+    uint32_t reserved = static_cast<uint32_t>(uint64_t{window} * parity / (fecBlock + parity));
+    return std::max<uint32_t>(window - reserved, 1);
+}
+
+uint32_t ChromaServer::parityFor(uint32_t packets) const {
+    if (lossRate < CHROMA_FEC_MIN_LOSS || fecMaxParity == 0) return 0;
+    double expected = std::ceil(lossRate * packets * CHROMA_FEC_MARGIN);
+    return std::clamp<uint32_t>(static_cast<uint32_t>(expected), 1, fecMaxParity);
+}
+
+// Perda vista pelo cliente = o que a FEC reconstruiu + o que precisou de
+// retransmissão. Sem a primeira parcela a FEC esconderia a perda e a
+// redundância cairia até a perda voltar a aparecer.
+void ChromaServer::updateLossEstimate() {
+    uint64_t sent = packetIndex - lossSampleSent;
+    if (sent < CHROMA_FEC_LOSS_SAMPLE) return;
+
+    uint64_t lost = fecRecovered + retransmissions;
+    double sample = std::min(1.0, static_cast<double>(lost - lossSampleLost) / static_cast<double>(sent));
+    lossRate += CHROMA_FEC_LOSS_GAIN * (sample - lossRate);
+    lossSampleSent = packetIndex;
+    lossSampleLost = lost;
+}
+
+bool ChromaServer::awaitingParity(uint32_t seq, RttEstimator::Clock::time_point now) const {
+    if (fecCover.empty()) return false;
+    auto paritySentAt = fecCover[seq % fecCover.size()];
+    if (paritySentAt == RttEstimator::Clock::time_point{}) return false;
+    if (paritySentAt == RttEstimator::Clock::time_point::max()) return true;
+
+    // Um SACK só reflete a paridade depois de uma ida e volta (mais o atraso do SACK)
+    auto horizon = std::chrono::duration<double, std::milli>(rtt.smoothedRttMs() + CHROMA_DELAYED_ACK_MS);
+    return now - paritySentAt < horizon;
+}
+
+void ChromaServer::schedulePump(uint32_t delayMs) {
+    if (pacingTimer != TimingWheel::NO_TIMER) return;
+    pacingTimer = scheduler.schedule(delayMs, [](void* self, uint64_t) {
+        auto* server = static_cast<ChromaServer*>(self);
+        server->pacingTimer = TimingWheel::NO_TIMER;
+        server->pump();
+    }, this, 0);
+}
+
+// Arquivo truncado no lugar durante o envio: parte do que saiu eram zeros
+// e o cliente não pode aceitar o resultado (veja FileCache)
+bool ChromaServer::abortIfTruncated() {
+    if (!file->truncated()) return false;
+
+    abortSession("arquivo alterado no servidor durante o envio");
+    return true;
+}
+
+void ChromaServer::abortSession(const std::string& reason) {
+    Packet nack(0, std::vector<char>(reason.begin(), reason.end()), ChromaFlag::NACK, addr);
+    sendPacket(nack, clientAddr);
+    cerr << RED << "[ChromaServer] " << fileName << ": " << reason << RESET << "\n";
+    finish(false);
+}
+
+void ChromaServer::finish(bool success) {
+    if (state == State::Finished) return;
+    state = State::Finished;
+
+    cancelTimers();
+    reactor.remove(sockfd);
+    if (readAhead) readAhead->cancel();
+
+    if (!success) {
+        cerr << RED << "[ChromaServer] Sessão encerrada sem concluir a transferência."
+             << RESET << "\n";
+    }
+    if (onFinished) onFinished(*this);
+}
+
+void ChromaServer::cancelTimers() {
+    scheduler.cancel(metaTimer);
+    scheduler.cancel(pacingTimer);
+    scheduler.cancel(probeTimer);
+    scheduler.cancel(prepareTimer);
+    metaTimer = pacingTimer = probeTimer = prepareTimer = TimingWheel::NO_TIMER;
+
+    for (uint32_t seq = base; seq != nextSeqNum; seq = nextSeq(seq)) {
+        if (PacketRing::Slot* slot = bufferPackets.find(seq)) {
+            scheduler.cancel(slot->timer);
+            slot->timer = TimingWheel::NO_TIMER;
+        }
+    }
+}
+
+void ChromaServer::receiveData() {
+    std::array<PacketView, CHROMA_BATCH_SIZE> views;
+
+    while (state == State::Preparing || state == State::Probing || state == State::AwaitingMetaAck ||
+           state == State::Transferring) {
+        int r = recvBatch(views);
+        if (r <= 0) break;
+
+        for (int i = 0; i < r; ++i) {
+            const PacketView& pkt = views[i];
+
+            if (isCorrupted(pkt)) {
+                cerr << RED << "[ChromaServer] Pacote corrompido ignorado."
+                     << RESET << "\n";
+                continue;
+            }
+
+            if (state == State::Preparing) {
+                continue;   // o cliente ainda não tem o que confirmar
+            }
+            else if (state == State::Probing) {
+                handleProbeAck(pkt);
+            }
+            else if (state == State::AwaitingMetaAck) {
+                handleMetaAck(pkt);
             }
-            if (oldBase != base) {
-                cerr << "[DEBUG] base avançou de " << (int)oldBase 
-                    << " para " << (int)base << "\n";
+            else if (pkt.flag == ChromaFlag::ACK) {
+                handleAck(pkt);
             }
-        } 
-        else if (pkt.flag == ChromaFlag::NACK) {
-            cout << ORANGE << "[ChromaServer] NACK recebido para seq "
-                << static_cast<int>(pkt.seqNum) << RESET << "\n";
+            else if (pkt.flag == ChromaFlag::SACK) {
+                SackView sack;
+                if (SackView::parse(pkt.data, sack)) {
+                    cerr << YELLOW << "[ChromaServer] SACK recebido: cumulativo "
+                        << sack.cumulative << " (+" << sack.bitmap.size() * 8 << " bits)"
+                        << RESET << "\n";
+                    applySack(sack);
+                }
+            }
+            else if (pkt.flag == ChromaFlag::NACK) {
+                cout << ORANGE << "[ChromaServer] NACK recebido para seq "
+                    << static_cast<int>(pkt.seqNum) << RESET << "\n";
+            }
+        }
+
+        // A base avança uma vez por lote de ACKs drenados
+        uint32_t oldBase = base;
+        while (base != nextSeqNum && !bufferPackets.contains(base)) {
+            base = nextSeq(base);
+        }
+        if (oldBase != base) {
+            cerr << "[DEBUG] base avançou de " << oldBase
+                << " para " << base << "\n";
         }
+    }
+
+    pump();
+}
 
+void ChromaServer::handleAck(const PacketView& pkt) {
+    uint32_t seq = pkt.seqNum;
+    cerr << YELLOW << "[ChromaServer] ACK recebido para seq "
+        << (int)seq << RESET << "\n";
+
+    auto now = RttEstimator::Clock::now();
+    if (PacketRing::Slot* slot = bufferPackets.find(seq)) {
+        if (slot->transmissions == 1) rtt.addSample(now - slot->sentAt);
+        scheduler.cancel(slot->timer);
+    }
+    if (bufferPackets.erase(seq)) {
+        congestion->onAck(1, rtt, now);
+        pacer.setRate(congestion->pacingRate(rtt));
     }
 }
 
-void ChromaServer::setTimerAndSendPacket(const Packet& pkt, int timeoutMs, const sockaddr_in& dest) {
-    uint8_t seq = pkt.seqNum;
+void ChromaServer::applySack(const SackView& sack) {
+    // ACK cumulativo fora de [base, nextSeqNum] é velho ou inválido
+    uint32_t inFlight = getSeqDistance(base, nextSeqNum);
+    if (getSeqDistance(base, sack.cumulative) > inFlight) {
+        return;
+    }
+
+    // Amostra de RTT: o envio mais recente entre os recém-confirmados que
+    // nunca foram retransmitidos (regra de Karn)
+    auto now = RttEstimator::Clock::now();
+    auto newestSent = RttEstimator::Clock::time_point::min();
+    uint32_t acked = 0;
+    auto release = [&](uint32_t seq) {
+        const PacketRing::Slot* slot = bufferPackets.find(seq);
+        if (!slot) return;
+        if (slot->transmissions == 1) {
+            newestSent = std::max(newestSent, slot->sentAt);
+        }
+        scheduler.cancel(slot->timer);
+        bufferPackets.erase(seq);
+        acked++;
+    };
 
-    {
-        std::lock_guard<std::mutex> lock(m_mutex);
-        bufferPackets[seq] = pkt;
+    // Tudo antes do cumulativo foi recebido: libera slots e timers de uma vez
+    while (base != sack.cumulative) {
+        release(base);
+        base = nextSeq(base);
     }
 
-    auto callback = [this, seq, dest]() {
-        std::lock_guard<std::mutex> lock(m_mutex);
-        if (bufferPackets.count(seq)) {
-            cerr << MAGENTA << "[ChromaServer] Timeout -> retransmitindo seq " << (int)seq << RESET << "\n";
-            sendPacket(bufferPackets[seq], dest);
+    // Bits seletivos: seqs depois do cumulativo que chegaram fora de ordem
+    size_t span = std::min<size_t>(sack.bitmap.size() * 8, getSeqDistance(base, nextSeqNum));
+    for (size_t i = 0; i < span; ++i) {
+        if (sack.has(i)) {
+            release((sack.cumulative + 1 + static_cast<uint32_t>(i)) & seqMask);
         }
+    }
+
+    if (newestSent != RttEstimator::Clock::time_point::min()) {
+        rtt.addSample(now - newestSent);
+    }
+
+    // Pacote reconstruído pela FEC foi perdido na rede: é congestionamento
+    // como o que vai para a retransmissão rápida, e conta como ela
+    bool lossDetected = false;
+    if (fecBlock > 0) {
+        Options options = parseOptions(sack.options, 0);
+        if (auto rec = options.find("rec"); rec != options.end()) {
+            uint64_t reported = strtoull(rec->second.c_str(), nullptr, 10);
+            if (reported > fecRecovered) {
+                fecRecovered = reported;
+                lossDetected = true;
+            }
+        }
+        updateLossEstimate();
+    }
+
+    if (inRecovery && getSeqDistance(recoveryPoint, base) <= getSeqDistance(recoveryPoint, nextSeqNum)) {
+        inRecovery = false;   // o cumulativo passou do ponto de recuperação
+    }
+
+    // Retransmissão rápida: buraco com pelo menos CHROMA_DUP_THRESHOLD pacotes
+    // confirmados acima dele é considerado perdido sem esperar o RTO. Com
+    // poucos pacotes em voo o limiar cai (early retransmit, RFC 5827).
+    uint32_t inFlightNow = getSeqDistance(base, nextSeqNum);
+    uint32_t dupThreshold = std::clamp<uint32_t>(inFlightNow > 1 ? inFlightNow - 1 : 1, 1, CHROMA_DUP_THRESHOLD);
+    uint32_t sackedAbove = 0;
+    for (size_t i = span; i-- > 0;) {
+        if (sack.has(i)) {
+            sackedAbove++;
+            continue;
+        }
+        if (sackedAbove < dupThreshold) continue;
+
+        uint32_t seq = (sack.cumulative + 1 + static_cast<uint32_t>(i)) & seqMask;
+        fastRetransmit(seq, now, lossDetected);
+    }
+    if (sackedAbove >= dupThreshold) {
+        // O próprio cumulativo é o primeiro buraco
+        fastRetransmit(sack.cumulative, now, lossDetected);
+    }
+
+    if (lossDetected && !inRecovery) {
+        congestion->onLoss(now);
+        inRecovery = true;
+        recoveryPoint = nextSeqNum;
+    }
+
+    if (acked > 0) {
+        congestion->onAck(acked, rtt, now);
+    }
+    pacer.setRate(congestion->pacingRate(rtt));
+}
+
+void ChromaServer::fastRetransmit(uint32_t seq, RttEstimator::Clock::time_point now, bool& lossDetected) {
+    PacketRing::Slot* slot = bufferPackets.find(seq);
+    if (!slot || slot->transmissions != 1) return;   // já retransmitido: fica com o RTO
+    if (awaitingParity(seq, now)) return;             // a FEC do bloco ainda pode cobrir
+
+    slot->transmissions++;
+    slot->sentAt = now;
+    lossDetected = true;
+    retransmissions++;
+
+    cerr << MAGENTA << "[ChromaServer] Retransmissão rápida do seq " << seq << RESET << "\n";
+    // Falha por arquivo truncado: o pump() seguinte aborta a sessão
+    if (sendRaw(slot->seqNum, slot->flag, slot->checksum, slot->data(), clientAddr) < 0) {
+        file->checkTruncated();
+    }
+}
+
+void ChromaServer::armRetransmitTimer(PacketRing::Slot& slot) {
+    auto fire = [](void* self, uint64_t seq) {
+        static_cast<ChromaServer*>(self)->onRetransmitTimeout(static_cast<uint32_t>(seq));
     };
+    slot.timer = scheduler.schedule(static_cast<uint32_t>(slot.rtoMs), fire, this, slot.seqNum);
+}
 
-    scheduler.addRepeatingTimeout(seq, timeoutMs, callback);
+void ChromaServer::onRetransmitTimeout(uint32_t seq) {
+    PacketRing::Slot* slot = bufferPackets.find(seq);
+    if (state != State::Transferring || !slot) return;
+    slot->timer = TimingWheel::NO_TIMER;
 
-    sendPacket(pkt, dest);
+    if (slot->transmissions >= CHROMA_MAX_TRANSMISSIONS) {
+        cerr << RED << "[ChromaServer] Cliente não responde após " << slot->transmissions
+             << " envios do seq " << seq << "." << RESET << "\n";
+        finish(false);
+        return;
+    }
+
+    // Só dobra o RTO da sessão se o pacote foi enviado depois do último
+    // backoff; assim uma rajada de perdas da mesma janela conta uma vez só
+    auto now = RttEstimator::Clock::now();
+    if (slot->sentAt >= lastBackoff) {
+        rtt.backoff();
+        congestion->onTimeout();
+        pacer.setRate(congestion->pacingRate(rtt));
+        inRecovery = false;
+        lastBackoff = now;
+    }
+    slot->rtoMs = rtt.rtoMs();
+    slot->transmissions++;
+    slot->sentAt = now;
+    retransmissions++;
+
+    cerr << MAGENTA << "[ChromaServer] Timeout -> retransmitindo seq " << seq
+         << " (RTO " << slot->rtoMs << " ms)" << RESET << "\n";
+    if (sendRaw(slot->seqNum, slot->flag, slot->checksum, slot->data(), clientAddr) < 0) {
+        file->checkTruncated();
+        if (abortIfTruncated()) return;
+    }
+
+    armRetransmitTimer(*slot);
 }
 
+void ChromaServer::negotiateWireVersion(const PacketView& ackMeta) {
+    // ACK de metadados vazio = cliente legado, que só entende seq de 8 bits
+    Options options = parseOptions(ackMeta.data, 0);
+    auto version = options.find("v");
+    auto window = options.find("win");
 
-Packet ChromaServer::makeMetaDataPacket(const string& filename, ifstream& file, size_t chunkSize) {
+    if (version != options.end() && version->second == to_string(CHROMA_VERSION_WIDE)) {
+        uint32_t clientWindow = maxWindowSize;
+        if (window != options.end()) {
+            clientWindow = static_cast<uint32_t>(strtoul(window->second.c_str(), nullptr, 10));
+        }
+        setWireVersion(CHROMA_VERSION_WIDE, clientWindow);
+    } else {
+        setWireVersion(CHROMA_VERSION_LEGACY, maxWindowSize);
+    }
+
+    cout << CYAN << "[ChromaServer] Protocolo v" << static_cast<int>(wireVersion)
+         << " com janela de " << windowSize << " pacotes" << RESET << "\n";
+}
+
+Packet ChromaServer::makeMetaDataPacket(const string& filename, uint64_t fileSize, size_t chunkSize) {
     string pathStr(filename);
     size_t lastSlash = pathStr.find_last_of("/\\");
     string shortFilename = (lastSlash == string::npos) ? pathStr : pathStr.substr(lastSlash + 1);
@@ -194,11 +841,9 @@ Packet ChromaServer::makeMetaDataPacket(const string& filename, ifstream& file,
         extension = shortFilename.substr(lastDot + 1);
     }
 
-    file.seekg(0, ios::end);
-    long long fileSize = file.tellg();
-    file.seekg(0, ios::beg);
-
-    int totalPackets = static_cast<int>(ceil((double)fileSize / chunkSize));
+    // Num GET com trecho os pacotes cobrem só o trecho; fileSize continua
+    // sendo o do arquivo inteiro, para o cliente pré-alocar a saída
+    int totalPackets = static_cast<int>(ceil((double)(rangeEnd - rangeStart) / chunkSize));
 
     vector<char> meta;
     auto appendStr = [&](const string& s) {
@@ -211,5 +856,32 @@ Packet ChromaServer::makeMetaDataPacket(const string& filename, ifstream& file,
     appendStr(to_string(fileSize));
     appendStr(to_string(totalPackets));
 
+    // Extensões opcionais: clientes antigos leem só os 4 campos acima
+    appendOption(meta, "v", to_string(CHROMA_VERSION_WIDE));
+    appendOption(meta, "win", to_string(maxWindowSize));
+    appendOption(meta, "chunk", to_string(chunkSize));
+    // Identifica a versão do arquivo: o cliente só retoma um download parcial
+    // (ou usa uma assinatura) se o arquivo no servidor for o mesmo
+    appendOption(meta, "ver", sourceVersion);
+    if (signatureBlock > 0 && !merkleLeavesRequested) {
+        appendOption(meta, "sig", to_string(signatureBlock));
+    }
+    if (!merkleRoot.empty()) {
+        appendOption(meta, "root", merkleRoot);
+    }
+    if (merkleLeavesRequested) {
+        appendOption(meta, "leaves", "1");
+    }
+    if (offeredCodec) {
+        appendOption(meta, "comp", offeredCodec->name());
+    }
+    if (fecBlock > 0) {
+        appendOption(meta, "fec", to_string(fecBlock));
+    }
+    if (rangeStart != 0 || rangeEnd != fileSize) {
+        appendOption(meta, "off", to_string(rangeStart));
+        appendOption(meta, "len", to_string(rangeEnd - rangeStart));
+    }
+
     return Packet(0, meta, ChromaFlag::META, addr);
 }
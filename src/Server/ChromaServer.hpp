@@ -1,34 +1,234 @@
 #pragma once
 
 #include "../Protocol/ChromaProtocol.hpp"
-#include "../Protocol/Timer.hpp"
+#include "../Protocol/Compression.hpp"
+#include "../Protocol/CongestionControl.hpp"
+#include "../Protocol/ErasureCode.hpp"
+#include "../Protocol/RttEstimator.hpp"
+#include "../Protocol/TimingWheel.hpp"
+#include "FileCache.hpp"
+#include "ReadAhead.hpp"
+#include "Reactor.hpp"
 
-#include <fstream>
+#include <functional>
 #include <string>
 #include <vector>
 #include <unordered_map>
-#include <mutex>
 
-struct TimeoutEvent {
-    uint8_t seq;
-    sockaddr_in dest;
-};
+constexpr int CHROMA_META_TIMEOUT_MS = 5000;
+constexpr int CHROMA_PROBE_INTERVAL_MS = 100;   // espera por rodada de sondas de PMTU
+constexpr int CHROMA_MAX_PROBES = 3;            // rodadas antes de ficar com o maior confirmado
+constexpr int CHROMA_PREPARE_POLL_MS = 20;      // consulta ao HashPool enquanto a sessão prepara
+constexpr int CHROMA_PREPARE_TIMEOUT_MS = 60000; // antes do cliente desistir da fila (2 min)
+constexpr uint16_t CHROMA_MAX_TRANSMISSIONS = 16;   // desiste do cliente depois disso
+
+// Redundância da FEC: paridades por bloco ~ perda estimada * pacotes * margem
+constexpr double CHROMA_FEC_INITIAL_LOSS = 0.01;
+constexpr double CHROMA_FEC_MIN_LOSS = 0.001;   // abaixo disso os blocos saem sem paridade
+constexpr double CHROMA_FEC_MARGIN = 2.0;
+constexpr double CHROMA_FEC_LOSS_GAIN = 0.25;   // peso de cada amostra na média móvel
+constexpr uint64_t CHROMA_FEC_LOSS_SAMPLE = 64; // pacotes enviados por amostra de perda
 
-class ChromaServer : public ChromaProtocol {
+// Sessão de envio de um arquivo para um cliente. É uma máquina de estados
+// dirigida pelo Reactor: não bloqueia nem faz espera ativa; cada datagrama
+// recebido ou timer vencido avança a transferência. Todos os métodos rodam
+// na thread do reactor dono da sessão.
+class ChromaServer : public ChromaProtocol, public Reactor::Handler {
 public:
-    ChromaServer(int winSize, const sockaddr_in& clientAddr);
+    enum class State { Idle, Preparing, Probing, AwaitingMetaAck, Transferring, Finished };
+
+    using FinishedCallback = std::function<void(ChromaServer&)>;
+
+    ChromaServer(Reactor& reactor, int winSize, const sockaddr_in& clientAddr,
+                 const std::string& ccAlgorithm = "newreno");
     ~ChromaServer();
 
-    void sendData(const char* filename, size_t chunkSize = 512);
+    // Abre o arquivo, espera o que é calculado fora do reactor (assinatura,
+    // árvore de Merkle), sonda o caminho (se o cliente aceita datagramas
+    // grandes), envia META e retorna; o resto acontece nos eventos.
+    // chunkSize 0 = o maior que o caminho suportar.
+    void sendData(const char* filename, size_t chunkSize = 512) override;
 
+    // Drena os datagramas disponíveis e reage a cada um
     void receiveData() override;
 
-    Packet makeMetaDataPacket(const std::string& filename, std::ifstream& file, size_t chunkSize);
+    void onEvent(uint32_t events) override;
+
+    // GET retransmitido pelo cliente: reenvia o META se o ACK ainda não veio
+    // (ou, preparando, o BUSY que mantém o cliente esperando)
+    void resendMeta();
+
+    // Chunks lidos antecipadamente por `worker` (0 = lê direto do mapeamento)
+    void setReadAhead(PrefetchWorker* worker, size_t chunks) {
+        prefetcher = worker;
+        readAheadChunks = chunks;
+    }
+
+    // Só os bytes [offset, offset + length) do arquivo (opções "off"/"len"
+    // do GET); o resto do protocolo não muda, o META diz o trecho servido
+    void setRange(uint64_t offset, uint64_t length) {
+        rangeOffset = offset;
+        rangeLength = length;
+    }
+
+    // Serve a assinatura de blocos do arquivo em vez do conteúdo (opção "sig"
+    // do GET, sempre CHROMA_DELTA_BLOCK); 0 serve o arquivo
+    void setSignatureBlock(uint32_t blockSize) { signatureBlock = blockSize; }
+
+    // Integridade (opções "merkle" e "leaves" do GET): raiz da árvore de
+    // Merkle no META, e/ou as folhas servidas no lugar do arquivo
+    void setMerkle(bool sendRoot, bool serveLeaves) {
+        merkleRootRequested = sendRoot;
+        merkleLeavesRequested = serveLeaves;
+    }
+
+    // Codecs que o cliente oferece (opção "comp" do GET, por preferência)
+    void setCodecOffer(std::string offer) { codecOffer = std::move(offer); }
+
+    // FEC em blocos de `block` pacotes com até `maxParity` paridades; só
+    // quando o cliente ofereceu ("fec" no GET). block 0 desliga.
+    void setFec(uint32_t block, uint32_t maxParity) {
+        fecBlock = std::min(block, CHROMA_FEC_MAX_BLOCK);
+        fecMaxParity = std::min(maxParity, CHROMA_FEC_MAX_PARITY);
+    }
+
+    // Maior datagrama que o cliente anunciou no GET (opção "dgram")
+    void setPeerMaxDatagram(size_t bytes) { peerMaxDatagram = bytes; }
+
+    // Chamado uma vez quando a sessão termina (sucesso ou falha)
+    void setOnFinished(FinishedCallback cb) { onFinished = std::move(cb); }
+
+    [[nodiscard]] State getState() const { return state; }
+    [[nodiscard]] int getSocket() const { return sockfd; }
+
+    Packet makeMetaDataPacket(const std::string& filename, uint64_t fileSize, size_t chunkSize);
+
+    // Põe o chunk de `seq` no anel, comprimido se o codec negociado ajudar
+    PacketRing::Slot* attachChunk(uint32_t seq, std::span<const char> chunk);
 
-    void setTimerAndSendPacket(const Packet& pkt, int timeoutMs, const sockaddr_in& dest);
+    // Soma o pacote recém-posto no anel ao bloco de FEC aberto
+    void protect(const PacketRing::Slot& slot, RttEstimator::Clock::time_point now);
+    void closeFecBlock(RttEstimator::Clock::time_point now);
+
+    // Paridades para um bloco de `packets` pacotes conforme a perda estimada
+    [[nodiscard]] uint32_t parityFor(uint32_t packets) const;
+    void updateLossEstimate();
+
+    // Janela para DATA: cwnd menos a parte reservada para a paridade
+    [[nodiscard]] uint32_t dataWindow() const;
+
+    // true se a paridade do bloco de `seq` ainda pode recuperá-lo no cliente
+    [[nodiscard]] bool awaitingParity(uint32_t seq, RttEstimator::Clock::time_point now) const;
+
+    // Arma o RTO do slot na roda de timers do reactor
+    void armRetransmitTimer(PacketRing::Slot& slot);
+
+    void onRetransmitTimeout(uint32_t seq);
+
+    // Diagnóstico do estimador de RTT da sessão
+    [[nodiscard]] double getSmoothedRttMs() const { return rtt.smoothedRttMs(); }
+    [[nodiscard]] double getRttVarianceMs() const { return rtt.rttVarianceMs(); }
+    [[nodiscard]] int getRtoMs() const { return rtt.rtoMs(); }
+
+    // Processa um SACK inteiro numa passada
+    void applySack(const SackView& sack);
+    void fastRetransmit(uint32_t seq, RttEstimator::Clock::time_point now, bool& lossDetected);
+    bool abortIfTruncated();
+    // NACK com o motivo para o cliente e fim da sessão
+    void abortSession(const std::string& reason);
+
+    // Ajusta formato de seq e janela conforme o ACK de metadados do cliente
+    void negotiateWireVersion(const PacketView& ackMeta);
 
 private:
-    sockaddr_in clientAddr{};    
-    Timer scheduler;
-    std::mutex m_mutex;
+    Reactor& reactor;
+    sockaddr_in clientAddr{};
+    TimingWheel& scheduler;
+    State state = State::Idle;
+    FinishedCallback onFinished;
+
+    std::string fileName;
+    std::shared_ptr<const FileCache::MappedFile> file;   // páginas do cache do processo
+    uint64_t fileOffset = 0;
+    uint64_t rangeOffset = 0;
+    uint64_t rangeLength = UINT64_MAX;
+    uint32_t signatureBlock = 0;
+    std::string sourceVersion;                // "ver" do arquivo pedido
+    bool merkleRootRequested = false;
+    bool merkleLeavesRequested = false;
+    std::string merkleRoot;                   // hex, vazio se não pedida
+    std::string codecOffer;
+    const Codec* offeredCodec = nullptr;      // anunciado no META
+    const Codec* codec = nullptr;             // confirmado no ACK do META
+    std::vector<std::vector<char>> compressed;   // payload ZDATA de cada slot do anel
+    uint64_t rawBytesSent = 0;
+    uint64_t wireBytesSent = 0;
+    uint32_t fecBlock = 0;
+    uint32_t fecMaxParity = 0;
+    FecEncoder fecEncoder;
+    uint32_t fecBlockSeq = 0;                 // seq do primeiro pacote do bloco aberto
+    std::vector<RttEstimator::Clock::time_point> fecCover;   // por slot: quando a paridade saiu
+    std::vector<std::vector<char>> parityPackets;            // paridades da rajada corrente
+    size_t parityUsed = 0;
+    uint64_t packetIndex = 0;                 // pacotes novos já enviados no trecho
+    uint64_t paritySent = 0;
+    uint64_t retransmissions = 0;
+    uint64_t fecRecovered = 0;                // reportado pelo cliente no SACK ("rec")
+    double lossRate = CHROMA_FEC_INITIAL_LOSS;
+    uint64_t lossSampleSent = 0;
+    uint64_t lossSampleLost = 0;
+    uint64_t rangeStart = 0;             // trecho servido, já limitado ao arquivo
+    uint64_t rangeEnd = 0;
+    PrefetchWorker* prefetcher = nullptr;
+    size_t readAheadChunks = 0;
+    std::shared_ptr<ReadAheadStream> readAhead;
+    size_t requestedChunk = 0;
+    size_t chunkSize = 0;
+    bool finishedReading = false;
+    std::vector<OutgoingPacket> burst;
+
+    // PMTU: datagramas candidatos (do maior para o menor) sondados antes do
+    // META; o chunk sai do maior confirmado pelo cliente
+    size_t peerMaxDatagram = UDP_MAX_PAYLOAD;
+    size_t pathDatagram = UDP_MAX_PAYLOAD;
+    std::vector<size_t> probeSizes;
+    std::vector<char> probePadding;
+    int probeRounds = 0;
+    TimingWheel::Handle probeTimer = TimingWheel::NO_TIMER;
+
+    TimingWheel::Handle prepareTimer = TimingWheel::NO_TIMER;
+    RttEstimator::Clock::time_point prepareDeadline{};
+
+    Packet metaPacket;
+    TimingWheel::Handle metaTimer = TimingWheel::NO_TIMER;
+    TimingWheel::Handle pacingTimer = TimingWheel::NO_TIMER;   // pacer ou read-ahead atrasado
+
+    RttEstimator rtt;
+    RttEstimator::Clock::time_point lastBackoff{};
+
+    std::unique_ptr<CongestionController> congestion;
+    Pacer pacer;
+    bool inRecovery = false;
+    uint32_t recoveryPoint = 0;
+
+    void prepare();
+    bool resolveSource();
+    [[nodiscard]] bool sourceFailed() const;
+    void sendPreparing();
+    void startTransfer();
+    bool startProbing();
+    void sendProbes();
+    void handleProbeAck(const PacketView& pkt);
+    void finishProbing();
+    void sendMeta();
+    void armMetaTimer();
+    void handleMetaAck(const PacketView& pkt);
+    void handleAck(const PacketView& pkt);
+
+    // Envia o que janela, cwnd e pacer permitirem; termina a sessão quando
+    // o arquivo todo foi lido e confirmado
+    void pump();
+    void schedulePump(uint32_t delayMs);
+    void finish(bool success);
+    void cancelTimers();
 };
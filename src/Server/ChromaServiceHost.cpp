@@ -1,8 +1,19 @@
 #include "ChromaServiceHost.hpp"
 #include "ChromaServer.hpp"
+#include "../Protocol/BlockSignature.hpp"
 
-ChromaServiceHost::ChromaServiceHost(int winSize, int port) : ChromaProtocol(winSize), running(false), serverPort(port), limitConnections(5)
+#include <fcntl.h>
+#include <sys/resource.h>
+
+ChromaServiceHost::ChromaServiceHost(int winSize, int port, bool reusePort) : ChromaProtocol(winSize), running(false), serverPort(port), limitConnections(CHROMA_DEFAULT_MAX_SESSIONS)
 {
+    if (reusePort) {
+        int one = 1;
+        if (setsockopt(sockfd, SOL_SOCKET, SO_REUSEPORT, &one, sizeof(one)) < 0) {
+            throw std::runtime_error("Erro ao habilitar SO_REUSEPORT");
+        }
+    }
+
     addr.sin_family = AF_INET;
     inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
     addr.sin_port = htons(serverPort);
@@ -17,58 +28,255 @@ ChromaServiceHost::ChromaServiceHost(int winSize, int port) : ChromaProtocol(win
         throw std::runtime_error("Erro ao obter porta atribuída ao gerenciador de requisições");
     }
 
+    int flags = fcntl(sockfd, F_GETFL, 0);
+    fcntl(sockfd, F_SETFL, flags | O_NONBLOCK);
+
+    // Cada sessão tem seu socket: milhares de downloads simultâneos
+    // estouram o limite padrão de descritores
+    rlimit files{};
+    if (getrlimit(RLIMIT_NOFILE, &files) == 0 && files.rlim_cur < files.rlim_max) {
+        files.rlim_cur = files.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &files);
+    }
+
     std::cout << "ChromaServiceHost rodando na porta: " << ntohs(addr.sin_port) << std::endl << "Com ip: " << inet_ntoa(addr.sin_addr) << std::endl;
 }
 
 ChromaServiceHost::~ChromaServiceHost() {
     StopServer();
+    sessions.clear();
 }
     
 void ChromaServiceHost::start() {
     running = true;
-    while (running)
-    {
-        Packet pkt;
+    reactor.add(sockfd, this);
+
+    std::cout << "Aguardando requisição de cliente..." << std::endl;
+    reactor.run();
+}
+
+void ChromaServiceHost::onEvent(uint32_t) {
+    receiveData();
+}
+
+void ChromaServiceHost::receiveData() {
+    std::array<PacketView, CHROMA_BATCH_SIZE> views;
+
+    while (running) {
+        int r = recvBatch(views);
+        if (r <= 0) break;
 
-        std::cout << "Aguardando requisição de cliente..." << std::endl;
-        
-        if (recvPacket(pkt) < 0) {
-            std::cerr << "Erro ao receber pacote" << std::endl;
-            continue;
+        for (int i = 0; i < r; ++i) {
+            const PacketView& pkt = views[i];
+
+            if (isCorrupted(pkt)) {
+                std::cerr << "Pacote corrompido recebido" << std::endl;
+                continue;
+            }
+            if (pkt.flag != ChromaFlag::GET) continue;
+
+            std::cout << "Pacote recebido do cliente: " << inet_ntoa(pkt.srcAddr.sin_addr) << ":" << ntohs(pkt.srcAddr.sin_port) << std::endl;
+
+            // O nome do arquivo vai até o primeiro '\0'; depois vêm as opções
+            GetRequest request;
+            request.client = pkt.srcAddr;
+            request.filename.assign(pkt.data.data(), strnlen(pkt.data.data(), pkt.data.size()));
+
+            Options options = parseOptions(pkt.data, 1);
+            auto number = [&](const char* key, uint64_t& out) {
+                if (auto it = options.find(key); it != options.end()) {
+                    out = std::strtoull(it->second.c_str(), nullptr, 10);
+                }
+            };
+            // Cliente antigo não anuncia "dgram": fica no datagrama padrão, sem sondas
+            uint64_t maxDatagram = UDP_MAX_PAYLOAD;
+            number("rid", request.requestId);
+            number("dgram", maxDatagram);
+            number("off", request.rangeOffset);
+            number("len", request.rangeLength);
+            request.maxDatagram = static_cast<size_t>(maxDatagram);
+
+            // Só há assinatura em blocos de CHROMA_DELTA_BLOCK: com qualquer
+            // outro tamanho o cliente escolheria quantas passadas pelo arquivo
+            // (e quanta memória) o servidor gasta. Fora disso serve o arquivo.
+            uint64_t signatureBlock = 0;
+            number("sig", signatureBlock);
+            if (signatureBlock == CHROMA_DELTA_BLOCK) {
+                request.signatureBlock = static_cast<uint32_t>(signatureBlock);
+            }
+            request.merkleRoot = options.count("merkle") != 0;
+            request.merkleLeaves = options.count("leaves") != 0;
+            if (auto comp = options.find("comp"); comp != options.end()) request.codecs = comp->second;
+            request.fec = options.count("fec") != 0;
+
+            admit(std::move(request));
         }
+    }
+}
+
+void ChromaServiceHost::admit(GetRequest request) {
+    auto now = std::chrono::steady_clock::now();
+    purgeRequests(now);
 
-        if (isCorrupted(pkt)) {
-            std::cerr << "Pacote corrompido recebido" << std::endl;
-            continue;
+    const uint64_t requestId = request.requestId;
+
+    // GET retransmitido: a sessão existente reenvia o META em vez de abrir outra
+    RequestKey key = makeKey(request.client, requestId);
+    if (auto it = requests.find(key); it != requests.end()) {
+        if (it->second.sessionFd >= 0) {
+            std::cout << "GET duplicado (rid " << requestId << "), reenviando META da sessão existente" << std::endl;
+            sessions.at(it->second.sessionFd).server->resendMeta();
+        } else {
+            std::cout << "GET duplicado (rid " << requestId << ") de sessão já encerrada ignorado" << std::endl;
         }
+        return;
+    }
 
-        std::cout << "Pacote recebido do cliente: " << inet_ntoa(pkt.srcAddr.sin_addr) << ":" << ntohs(pkt.srcAddr.sin_port) << std::endl;
+    // GET repetido de quem já está na fila só renova a espera
+    for (size_t i = 0; i < pending.size(); ++i) {
+        if (makeKey(pending[i].request.client, pending[i].request.requestId) == key) {
+            pending[i].lastSeen = now;
+            sendQueued(pending[i].request.client, i + 1);
+            return;
+        }
+    }
 
-        CreateServer(inet_ntoa(pkt.srcAddr.sin_addr), pkt);
+    if (sessions.size() < static_cast<size_t>(limitConnections)) {
+        CreateServer(request);
+        return;
     }
+
+    if (pending.size() < pendingDepth) {
+        pending.push_back({std::move(request), now});
+        std::cout << "Limite de " << limitConnections << " sessões atingido; requisição na fila ("
+                  << pending.size() << "/" << pendingDepth << ")" << std::endl;
+        sendQueued(pending.back().request.client, pending.size());
+        return;
+    }
+
+    sendBusy(request.client);
+}
+
+void ChromaServiceHost::admitPending() {
+    auto now = std::chrono::steady_clock::now();
+    while (sessions.size() < static_cast<size_t>(limitConnections) && !pending.empty()) {
+        PendingRequest req = std::move(pending.front());
+        pending.pop_front();
+
+        if (now - req.lastSeen > std::chrono::milliseconds(CHROMA_PENDING_TTL_MS)) {
+            continue;   // o cliente já desistiu
+        }
+        CreateServer(req.request);
+    }
+}
+
+void ChromaServiceHost::purgeRequests(std::chrono::steady_clock::time_point now) {
+    if (now < nextRequestPurge) return;
+    nextRequestPurge = now + std::chrono::seconds(1);
+
+    std::erase_if(requests, [&](const auto& entry) {
+        return entry.second.sessionFd < 0 && entry.second.expiresAt <= now;
+    });
+}
+
+void ChromaServiceHost::sendBusy(const sockaddr_in& client) {
+    // A dica cresce com a fila: quanto mais gente esperando, mais tarde volta
+    size_t rounds = 1 + pending.size() / static_cast<size_t>(limitConnections);
+    int retryMs = static_cast<int>(std::min<size_t>(CHROMA_BUSY_RETRY_MS * rounds, CHROMA_BUSY_RETRY_MAX_MS));
+
+    std::vector<char> payload;
+    appendOption(payload, "retry", std::to_string(retryMs));
+    sendPacket(0, ChromaFlag::BUSY, payload, client);
+
+    std::cout << "Servidor lotado: BUSY para " << inet_ntoa(client.sin_addr) << ":" << ntohs(client.sin_port)
+              << " (tentar em " << retryMs << " ms)" << std::endl;
 }
 
-void ChromaServiceHost::CreateServer(const char* ip, Packet pkt) {
-    std::thread([this, pkt]()
+// Sem resposta o cliente não sabe que ficou na fila e desiste do contato;
+// com ela, repete o GET a cada dica e o lugar não vence por CHROMA_PENDING_TTL_MS
+void ChromaServiceHost::sendQueued(const sockaddr_in& client, size_t position) {
+    std::vector<char> payload;
+    appendOption(payload, "retry", std::to_string(CHROMA_QUEUE_KEEPALIVE_MS));
+    appendOption(payload, "queued", std::to_string(position));
+    sendPacket(0, ChromaFlag::BUSY, payload, client);
+}
+
+void ChromaServiceHost::CreateServer(const GetRequest& request) {
+    // sendData pode encerrar a sessão na hora (arquivo inexistente), então
+    // ela já precisa estar registrada; se algo lança depois disso, o
+    // registro é desfeito abaixo para não prender um lugar de admissão
+    int registeredFd = -1;
+    try 
     {
-        try 
-        {
-            ChromaServer server(windowSize, pkt.srcAddr);
+        auto server = std::make_unique<ChromaServer>(reactor, static_cast<int>(maxWindowSize), request.client, congestionAlgorithm);
+        ChromaServer* session = server.get();
+        int fd = session->getSocket();
 
-            server.sendData(std::string(pkt.data.begin(), pkt.data.end()).c_str(), 2000);
+        reactor.add(fd, session);
+        session->setReadAhead(&prefetcher, readAheadChunks);
+        session->setOnFinished([this](ChromaServer& finished) {
+            // Só destrói depois da rodada de eventos, quando ninguém mais usa a sessão
+            reactor.defer(&ChromaServiceHost::reapSession, this, static_cast<uint64_t>(finished.getSocket()));
+        });
+        RequestKey key = makeKey(request.client, request.requestId);
+        sessions.emplace(fd, Session{std::move(server), key});
+        registeredFd = fd;
+        requests[key] = {fd, {}};
 
-        } catch (const std::exception& e)
-        {
-            std::cerr << "Erro ao iniciar servidor para cliente: " << e.what() << std::endl;
+        session->setPeerMaxDatagram(request.maxDatagram);
+        session->setRange(request.rangeOffset, request.rangeLength);
+        session->setSignatureBlock(request.signatureBlock);
+        session->setMerkle(request.merkleRoot, request.merkleLeaves);
+        session->setCodecOffer(request.codecs);
+        session->setFec(request.fec ? fecBlock : 0, fecMaxParity);
+        session->sendData(request.filename.c_str(), 0);   // chunk conforme a PMTU sondada
+
+        std::cout << "Sessões ativas: " << sessions.size() << std::endl;
+    } catch (const std::exception& e)
+    {
+        std::cerr << "Erro ao iniciar servidor para cliente: " << e.what() << std::endl;
+        if (registeredFd < 0) return;
+
+        // O destrutor da sessão tira o socket do reactor e cancela os timers;
+        // um reapSession já adiado não a encontra mais e não faz nada
+        if (auto it = sessions.find(registeredFd); it != sessions.end()) {
+            if (auto req = requests.find(it->second.key); req != requests.end() && req->second.sessionFd == registeredFd) {
+                requests.erase(req);
+            }
+            sessions.erase(it);
         }
-    }).detach();
+        admitPending();
+    }
+}
+
+void ChromaServiceHost::reapSession(void* host, uint64_t fd) {
+    auto* self = static_cast<ChromaServiceHost*>(host);
+    auto session = self->sessions.find(static_cast<int>(fd));
+    if (session == self->sessions.end()) return;
+
+    // Com id, a entrada fica mais um pouco para absorver GETs atrasados; sem
+    // id um novo GET do mesmo endereço pode ser um pedido legítimo
+    RequestKey key = session->second.key;
+    if (auto it = self->requests.find(key); it != self->requests.end() && it->second.sessionFd == session->first) {
+        if (key.id != 0) {
+            it->second.sessionFd = -1;
+            it->second.expiresAt = std::chrono::steady_clock::now() + std::chrono::milliseconds(CHROMA_REQUEST_TTL_MS);
+        } else {
+            self->requests.erase(it);
+        }
+    }
+
+    self->sessions.erase(session);
+    self->admitPending();
 }
 
 void ChromaServiceHost::StopServer()
 {
-    if (running) {
-        running = false;
-        close(sockfd);
+    // O socket é fechado pelo destrutor de ChromaProtocol, depois que o
+    // reactor parou de usá-lo
+    bool wasRunning = running.exchange(false);
+    reactor.stop();
+    if (wasRunning) {
         std::cout << "ChromaServiceHost parado." << std::endl;
     }
-}
\ No newline at end of file
+}
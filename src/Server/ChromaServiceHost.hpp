@@ -1,23 +1,140 @@
 #pragma once
 
 #include "../Protocol/ChromaProtocol.hpp"
+#include "ReadAhead.hpp"
+#include "Reactor.hpp"
 
-class ChromaServiceHost : public ChromaProtocol
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+constexpr int CHROMA_DEFAULT_MAX_SESSIONS = 5;
+constexpr size_t CHROMA_DEFAULT_PENDING_DEPTH = 32;
+constexpr int CHROMA_BUSY_RETRY_MAX_MS = 5000;
+constexpr int CHROMA_PENDING_TTL_MS = 6000;      // cliente que não repete o GET nesse prazo desistiu
+static_assert(CHROMA_QUEUE_KEEPALIVE_MS * 2 < CHROMA_PENDING_TTL_MS, "um GET perdido não pode custar o lugar na fila");
+constexpr int CHROMA_REQUEST_TTL_MS = 3000;      // quanto um GET já encerrado ainda é reconhecido
+
+class ChromaServer;
+
+// Recebe os GETs e multiplexa todas as sessões num único Reactor: uma thread
+// atende muitos downloads, acordando só por datagrama ou timer vencido.
+class ChromaServiceHost : public ChromaProtocol, public Reactor::Handler
 {
+public:
+    // O que um GET pede; campos opcionais ausentes ficam com o padrão
+    struct GetRequest {
+        sockaddr_in client{};
+        std::string filename;
+        uint64_t requestId{0};                  // "rid"
+        size_t maxDatagram{UDP_MAX_PAYLOAD};    // "dgram"
+        uint64_t rangeOffset{0};                // "off"
+        uint64_t rangeLength{UINT64_MAX};       // "len"
+        uint32_t signatureBlock{0};             // "sig"
+        bool merkleRoot{false};                 // "merkle"
+        bool merkleLeaves{false};               // "leaves"
+        std::string codecs;                     // "comp"
+        bool fec{false};                        // "fec": o cliente decodifica paridades
+    };
+
 private:
     sockaddr_in serverAddr;
-    bool running = false;
+    std::atomic<bool> running{false};
     int serverPort;
     int limitConnections;
+    std::string congestionAlgorithm = "newreno";
+
+    // Identifica um GET: o cliente repete o mesmo id ao retransmitir.
+    // Clientes antigos não mandam id (0) e são identificados só pelo endereço.
+    struct RequestKey {
+        uint32_t ip{0};
+        uint16_t port{0};
+        uint64_t id{0};
+        bool operator==(const RequestKey&) const = default;
+    };
+    struct RequestKeyHash {
+        size_t operator()(const RequestKey& k) const noexcept {
+            uint64_t h = (static_cast<uint64_t>(k.ip) << 16 | k.port) * 0x9E3779B97F4A7C15ULL;
+            return static_cast<size_t>(h ^ (k.id + (h << 6) + (h >> 2)));
+        }
+    };
+    // Sessão que atende o GET, ou -1 se já terminou e a entrada só segura
+    // duplicatas atrasadas até expiresAt
+    struct RequestEntry {
+        int sessionFd{-1};
+        std::chrono::steady_clock::time_point expiresAt;
+    };
+
+    // GET aceito mas ainda sem vaga de sessão
+    struct PendingRequest {
+        GetRequest request;
+        std::chrono::steady_clock::time_point lastSeen;
+    };
+
+    struct Session {
+        std::unique_ptr<ChromaServer> server;
+        RequestKey key;
+    };
+
+    size_t pendingDepth = CHROMA_DEFAULT_PENDING_DEPTH;
+    std::deque<PendingRequest> pending;
+
+    std::unordered_map<RequestKey, RequestEntry, RequestKeyHash> requests;
+    std::chrono::steady_clock::time_point nextRequestPurge{};
+
+    size_t readAheadChunks = CHROMA_DEFAULT_READAHEAD_CHUNKS;
+    uint32_t fecBlock = 0;
+    uint32_t fecMaxParity = 0;
+
+    Reactor reactor;
+    PrefetchWorker prefetcher;   // I/O de disco fora da thread do reactor
+    std::unordered_map<int, Session> sessions;   // por socket da sessão
+
+    static void reapSession(void* host, uint64_t fd);
+    static RequestKey makeKey(const sockaddr_in& client, uint64_t requestId) {
+        return {client.sin_addr.s_addr, client.sin_port, requestId};
+    }
+
+    // Responde duplicata, admite, enfileira ou recusa com BUSY
+    void admit(GetRequest request);
+    void admitPending();
+    void sendBusy(const sockaddr_in& client);
+    // Avisa quem está na fila (posição a partir de 1) de quando repetir o GET
+    void sendQueued(const sockaddr_in& client, size_t position);
+    void purgeRequests(std::chrono::steady_clock::time_point now);
 
 public:
-    ChromaServiceHost(int winSize, int port = 8080);
+    // Com reusePort vários hosts escutam a mesma porta (SO_REUSEPORT) e o
+    // kernel distribui os clientes entre eles
+    ChromaServiceHost(int winSize, int port = 8080, bool reusePort = false);
     ~ChromaServiceHost();
 
     void start();
-    void CreateServer(const char* ip, Packet pkt);
+    void CreateServer(const GetRequest& request);
+    // Pode ser chamado de outra thread; start() retorna em seguida
     void StopServer();
     bool isRunning() const { return running; }
+    void setCongestionControl(const std::string& algorithm) { congestionAlgorithm = algorithm; }
+
+    // Sessões simultâneas e GETs em espera; além disso o cliente recebe BUSY
+    void setAdmissionLimits(int maxSessions, size_t queueDepth) {
+        limitConnections = std::max(maxSessions, 1);
+        pendingDepth = queueDepth;
+    }
+    // Chunks lidos antecipadamente por sessão; 0 desliga o read-ahead
+    void setReadAhead(size_t chunks) { readAheadChunks = chunks; }
+    // Paridades por blocos de `block` pacotes para clientes que aceitam FEC; 0 desliga
+    void setFec(uint32_t block, uint32_t maxParity) {
+        fecBlock = block;
+        fecMaxParity = maxParity;
+    }
+    [[nodiscard]] size_t activeSessions() const { return sessions.size(); }
+    [[nodiscard]] size_t pendingRequests() const { return pending.size(); }
+    void onEvent(uint32_t events) override;
     void sendData(const char* data, size_t len) override {}
-    void receiveData() override {}
-};
\ No newline at end of file
+    void receiveData() override;
+};
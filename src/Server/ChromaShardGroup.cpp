@@ -0,0 +1,87 @@
+#include "ChromaShardGroup.hpp"
+
+#include <pthread.h>
+#include <sched.h>
+
+#include <iostream>
+#include <latch>
+
+ChromaShardGroup::ChromaShardGroup(int winSize, int port, unsigned shards)
+    : windowSize(winSize), port(port)
+{
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) == 0) {
+        for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+            if (CPU_ISSET(cpu, &allowed)) cpus.push_back(cpu);
+        }
+    }
+    if (cpus.empty()) cpus.push_back(0);
+
+    shardCount = shards > 0 ? shards : static_cast<unsigned>(cpus.size());
+}
+
+ChromaShardGroup::~ChromaShardGroup() {
+    stop();
+    for (auto& t : threads) {
+        if (t.joinable()) t.join();
+    }
+}
+
+void ChromaShardGroup::start() {
+    hosts.resize(shardCount);
+    std::vector<std::exception_ptr> errors(shardCount);
+    std::latch ready(shardCount);
+
+    // Cada host é criado já na sua thread fixada, para que socket, buffers e
+    // tabela de sessões sejam tocados primeiro pelo núcleo que vai usá-los
+    for (unsigned i = 0; i < shardCount; ++i) {
+        threads.emplace_back([this, i, &errors, &ready]() {
+            runShard(i, errors[i]);
+            ready.count_down();
+            if (!errors[i] && hosts[i]) hosts[i]->start();
+        });
+    }
+    ready.wait();
+
+    for (auto& error : errors) {
+        if (error) {
+            stop();
+            for (auto& t : threads) t.join();
+            threads.clear();
+            std::rethrow_exception(error);
+        }
+    }
+
+    std::cout << "ChromaShardGroup: " << shardCount << " shard(s) na porta " << port << std::endl;
+
+    for (auto& t : threads) t.join();
+    threads.clear();
+}
+
+void ChromaShardGroup::runShard(unsigned index, std::exception_ptr& error) {
+    int cpu = cpus[index % cpus.size()];
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0) {
+        std::cerr << "Aviso: não foi possível fixar o shard " << index
+                  << " no núcleo " << cpu << std::endl;
+    }
+
+    try {
+        hosts[index] = std::make_unique<ChromaServiceHost>(windowSize, port, true);
+        hosts[index]->setCongestionControl(congestionAlgorithm);
+        hosts[index]->setAdmissionLimits(maxSessions, queueDepth);
+        hosts[index]->setReadAhead(readAheadChunks);
+        hosts[index]->setFec(fecBlock, fecMaxParity);
+    } catch (...) {
+        error = std::current_exception();
+    }
+}
+
+void ChromaShardGroup::stop() {
+    for (auto& host : hosts) {
+        if (host) host->StopServer();
+    }
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "ChromaServiceHost.hpp"
+
+#include <exception>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+constexpr unsigned CHROMA_MAX_SHARDS = 1024;
+
+// N cópias independentes do ChromaServiceHost escutando a mesma porta com
+// SO_REUSEPORT, cada uma com seu reactor numa thread fixada a um núcleo.
+// O kernel espalha os clientes pelo hash do endereço, então o GET e toda a
+// transferência de um cliente ficam no mesmo núcleo, sem trava entre shards.
+class ChromaShardGroup {
+public:
+    // shards = 0 usa um shard por núcleo disponível para o processo
+    ChromaShardGroup(int winSize, int port = 8080, unsigned shards = 0);
+    ~ChromaShardGroup();
+
+    void setCongestionControl(const std::string& algorithm) { congestionAlgorithm = algorithm; }
+
+    // Limites de admissão de cada shard
+    void setAdmissionLimits(int maxSessions, size_t queueDepth) {
+        this->maxSessions = maxSessions;
+        this->queueDepth = queueDepth;
+    }
+    void setReadAhead(size_t chunks) { readAheadChunks = chunks; }
+    void setFec(uint32_t block, uint32_t maxParity) {
+        fecBlock = block;
+        fecMaxParity = maxParity;
+    }
+
+    // Sobe os shards e bloqueia até stop()
+    void start();
+    void stop();
+
+    [[nodiscard]] unsigned size() const { return shardCount; }
+
+private:
+    int windowSize;
+    int port;
+    unsigned shardCount;
+    std::string congestionAlgorithm = "newreno";
+    int maxSessions = CHROMA_DEFAULT_MAX_SESSIONS;
+    size_t queueDepth = CHROMA_DEFAULT_PENDING_DEPTH;
+    size_t readAheadChunks = CHROMA_DEFAULT_READAHEAD_CHUNKS;
+    uint32_t fecBlock = 0;
+    uint32_t fecMaxParity = 0;
+
+    std::vector<int> cpus;   // núcleos permitidos, na ordem de afinidade
+    std::vector<std::unique_ptr<ChromaServiceHost>> hosts;
+    std::vector<std::thread> threads;
+
+    void runShard(unsigned index, std::exception_ptr& error);
+};
@@ -0,0 +1,282 @@
+#include "FileCache.hpp"
+#include "HashPool.hpp"
+#include "../Protocol/BlockSignature.hpp"
+
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <array>
+#include <atomic>
+#include <exception>
+#include <mutex>
+
+namespace {
+
+// Mapeamentos vivos, consultados pelo tratador de SIGBUS sem travas
+constexpr size_t GUARD_SLOTS = 4096;
+
+struct Guard {
+    std::atomic<uintptr_t> begin{0};
+    std::atomic<uintptr_t> end{0};
+    std::atomic<bool> truncated{false};
+};
+
+std::array<Guard, GUARD_SLOTS> guards;
+struct sigaction previousBusAction{};
+uintptr_t pageSize = 4096;
+
+// Falta de página além do fim de um arquivo truncado: o resto do mapeamento
+// vira páginas zeradas e a instrução é refeita. SIGBUS fora dos mapeamentos
+// do cache volta ao tratamento anterior.
+void onSigbus(int sig, siginfo_t* info, void* context) {
+    auto addr = reinterpret_cast<uintptr_t>(info->si_addr);
+    for (Guard& guard : guards) {
+        uintptr_t begin = guard.begin.load(std::memory_order_acquire);
+        uintptr_t end = guard.end.load(std::memory_order_acquire);
+        if (begin == 0 || addr < begin || addr >= end) continue;
+
+        guard.truncated.store(true, std::memory_order_release);
+        uintptr_t page = addr & ~(pageSize - 1);
+        void* zeros = mmap(reinterpret_cast<void*>(page), end - page, PROT_READ,
+                           MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED, -1, 0);
+        if (zeros != MAP_FAILED) return;
+        break;
+    }
+
+    if (previousBusAction.sa_flags & SA_SIGINFO) {
+        if (previousBusAction.sa_sigaction) {
+            previousBusAction.sa_sigaction(sig, info, context);
+            return;
+        }
+    } else if (previousBusAction.sa_handler != SIG_DFL && previousBusAction.sa_handler != SIG_IGN) {
+        previousBusAction.sa_handler(sig);
+        return;
+    }
+    // Sem tratador anterior: refaz a falta com o padrão (core dump)
+    signal(SIGBUS, SIG_DFL);
+}
+
+void installSigbusHandler() {
+    static std::once_flag installed;
+    std::call_once(installed, []() {
+        pageSize = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+        struct sigaction action{};
+        action.sa_sigaction = onSigbus;
+        action.sa_flags = SA_SIGINFO;
+        sigemptyset(&action.sa_mask);
+        sigaction(SIGBUS, &action, &previousBusAction);
+    });
+}
+
+// -1 se a tabela está cheia: o mapeamento fica sem proteção
+int registerGuard(const char* data, size_t size) {
+    installSigbusHandler();
+    auto begin = reinterpret_cast<uintptr_t>(data);
+    uintptr_t end = (begin + size + pageSize - 1) & ~(pageSize - 1);
+    for (size_t i = 0; i < guards.size(); ++i) {
+        uintptr_t expected = 0;
+        if (guards[i].begin.compare_exchange_strong(expected, UINTPTR_MAX, std::memory_order_acq_rel)) {
+            guards[i].truncated.store(false, std::memory_order_relaxed);
+            guards[i].end.store(end, std::memory_order_release);
+            guards[i].begin.store(begin, std::memory_order_release);
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
+void releaseGuard(int slot) {
+    guards[slot].end.store(0, std::memory_order_release);
+    guards[slot].begin.store(0, std::memory_order_release);
+}
+
+}
+
+FileCache::MappedFile::~MappedFile() {
+    if (guard >= 0) releaseGuard(guard);
+    if (owned.empty() && mapped && length > 0) {
+        munmap(const_cast<char*>(mapped), length);
+    }
+    if (fd >= 0) close(fd);
+}
+
+bool FileCache::MappedFile::truncated() const {
+    return shrunk.load(std::memory_order_acquire) ||
+           (guard >= 0 && guards[guard].truncated.load(std::memory_order_acquire));
+}
+
+bool FileCache::MappedFile::checkTruncated() const {
+    struct stat st{};
+    if (fd >= 0 && fstat(fd, &st) == 0 && static_cast<size_t>(st.st_size) < length) {
+        shrunk.store(true, std::memory_order_release);
+    }
+    return truncated();
+}
+
+std::string FileCache::MappedFile::version() const {
+    return std::to_string(length) + "-" + std::to_string(modified.tv_sec) + "." +
+           std::to_string(modified.tv_nsec);
+}
+
+// Os jobs rodam numa thread do HashPool: exceção que escapasse derrubaria o
+// processo. A falha fica registrada e a sessão que espera desiste com NACK.
+std::shared_ptr<const FileCache::MappedFile> FileCache::MappedFile::signature() const {
+    std::lock_guard<std::mutex> lock(derivedMtx);
+    if (signatureState == Derivation::Idle) {
+        signatureState = Derivation::Running;
+        // O job segura o arquivo: uma remoção do cache no meio não desfaz o mapeamento
+        HashPool::instance().submit([self = shared_from_this()]() {
+            std::shared_ptr<const MappedFile> built;
+            try {
+                built = std::make_shared<const MappedFile>(
+                    BlockSignature::encode(self->bytes(), CHROMA_DELTA_BLOCK, self->version()),
+                    self->device, self->inode, self->modified);
+            } catch (const std::exception&) {
+            }
+            std::lock_guard<std::mutex> lock(self->derivedMtx);
+            self->blockSignature = std::move(built);
+            self->signatureState = self->blockSignature ? Derivation::Ready : Derivation::Failed;
+        });
+    }
+    return blockSignature;
+}
+
+bool FileCache::MappedFile::signatureFailed() const {
+    std::lock_guard<std::mutex> lock(derivedMtx);
+    return signatureState == Derivation::Failed;
+}
+
+std::shared_ptr<const MerkleTree> FileCache::MappedFile::merkleTree() const {
+    std::lock_guard<std::mutex> lock(derivedMtx);
+    if (treeState == Derivation::Idle) {
+        treeState = Derivation::Running;
+        HashPool::instance().submit([self = shared_from_this()]() {
+            std::shared_ptr<const MerkleTree> built;
+            try {
+                built = std::make_shared<const MerkleTree>(MerkleTree::build(self->bytes(), self->version()));
+            } catch (const std::exception&) {
+            }
+            std::lock_guard<std::mutex> lock(self->derivedMtx);
+            self->tree = std::move(built);
+            self->treeState = self->tree ? Derivation::Ready : Derivation::Failed;
+        });
+    }
+    return tree;
+}
+
+bool FileCache::MappedFile::merkleTreeFailed() const {
+    std::lock_guard<std::mutex> lock(derivedMtx);
+    return treeState == Derivation::Failed;
+}
+
+std::shared_ptr<const FileCache::MappedFile> FileCache::MappedFile::merkleLeaves() const {
+    std::shared_ptr<const MerkleTree> built = merkleTree();
+    if (!built) return nullptr;
+    std::lock_guard<std::mutex> lock(derivedMtx);
+    if (!leaves) {
+        leaves = std::make_shared<const MappedFile>(built->encodeLeaves(), device, inode, modified);
+    }
+    return leaves;
+}
+
+FileCache& FileCache::instance() {
+    static FileCache cache;
+    return cache;
+}
+
+std::shared_ptr<const FileCache::MappedFile> FileCache::acquire(const std::string& path) {
+    // Versão e tamanho vêm do descritor aberto: um stat pelo caminho podia
+    // ser de outro inode se o arquivo fosse trocado entre as duas chamadas
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return nullptr;
+    struct stat st{};
+    if (fstat(fd, &st) < 0 || !S_ISREG(st.st_mode)) {
+        close(fd);
+        return nullptr;
+    }
+    Key key{st.st_dev, st.st_ino};
+    size_t size = static_cast<size_t>(st.st_size);
+
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (auto it = index.find(key); it != index.end()) {
+            const MappedFile& cached = *it->second->file;
+            if (cached.length == size && !cached.truncated() &&
+                cached.modified.tv_sec == st.st_mtim.tv_sec &&
+                cached.modified.tv_nsec == st.st_mtim.tv_nsec) {
+                lru.splice(lru.begin(), lru, it->second);
+                counters.hits++;
+                close(fd);
+                return it->second->file;
+            }
+            // Mudou em disco: a versão antiga some do cache (quem a usa segue com ela)
+            counters.cachedBytes -= cached.length;
+            lru.erase(it->second);
+            index.erase(it);
+        }
+    }
+
+    // Miss: mapeia fora da trava para não segurar as outras sessões.
+    // Quem lê é o read-ahead das sessões, sempre em ordem crescente
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+    const char* data = nullptr;
+    if (size > 0) {
+        void* addr = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+        if (addr == MAP_FAILED) {
+            close(fd);
+            return nullptr;
+        }
+        data = static_cast<const char*>(addr);
+    }
+
+    auto created = std::make_shared<MappedFile>(data, size, st.st_dev, st.st_ino, st.st_mtim);
+    created->fd = fd;
+    if (data) created->guard = registerGuard(data, size);
+    std::shared_ptr<const MappedFile> file = std::move(created);
+
+    std::lock_guard<std::mutex> lock(mtx);
+    counters.misses++;
+
+    // Maior que o orçamento inteiro: serve sem cachear
+    if (size > budget) return file;
+
+    if (auto it = index.find(key); it != index.end()) {
+        // Outra sessão mapeou o mesmo arquivo enquanto estávamos sem a trava
+        counters.cachedBytes -= it->second->file->length;
+        lru.erase(it->second);
+        index.erase(it);
+    }
+    lru.push_front({key, file});
+    index[key] = lru.begin();
+    counters.cachedBytes += size;
+    evictLocked();
+    return file;
+}
+
+void FileCache::setBudget(size_t bytes) {
+    std::lock_guard<std::mutex> lock(mtx);
+    budget = bytes;
+    evictLocked();
+}
+
+FileCache::Stats FileCache::stats() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    Stats s = counters;
+    s.entries = lru.size();
+    return s;
+}
+
+void FileCache::evictLocked() {
+    // Nunca remove a entrada mais recente: ela acabou de ser pedida
+    while (counters.cachedBytes > budget && lru.size() > 1) {
+        Entry& victim = lru.back();
+        counters.cachedBytes -= victim.file->length;
+        index.erase(victim.key);
+        lru.pop_back();
+        counters.evictions++;
+    }
+}
@@ -0,0 +1,142 @@
+#pragma once
+
+#include "../Protocol/MerkleTree.hpp"
+
+#include <sys/types.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+
+constexpr size_t CHROMA_DEFAULT_CACHE_BYTES = 256ull * 1024 * 1024;
+
+// Cache de arquivos do processo, compartilhado por todas as sessões e shards.
+// Cada arquivo é mapeado (mmap) uma vez e os DATA saem direto das páginas
+// mapeadas, sem leitura nem cópia por cliente. Entradas são removidas por LRU
+// quando o total mapeado passa do orçamento; quem ainda usa um arquivo
+// removido mantém o mapeamento vivo pelo shared_ptr até terminar.
+//
+// Arquivos devem ser substituídos por rename (o mapeamento segue com o inode
+// antigo). Truncar no lugar um arquivo mapeado faria o acesso às páginas além
+// do novo fim gerar SIGBUS: o cache trata esse SIGBUS trocando o resto do
+// mapeamento por páginas zeradas e marcando o arquivo como truncado. Quando
+// quem toca as páginas é o kernel (sendmsg) o erro é EFAULT, e a sessão
+// confere o tamanho com checkTruncated(). Nos dois casos a sessão que serve
+// o arquivo aborta em vez de mandar zeros como conteúdo.
+class FileCache {
+public:
+    // Arquivo mapeado e imutável enquanto houver referência
+    class MappedFile : public std::enable_shared_from_this<MappedFile> {
+    public:
+        MappedFile(const char* data, size_t size, dev_t dev, ino_t ino, timespec mtime)
+            : mapped(data), length(size), device(dev), inode(ino), modified(mtime) {}
+        // Conteúdo gerado em memória (ex.: assinatura), servido como um arquivo
+        MappedFile(std::vector<char> contents, dev_t dev, ino_t ino, timespec mtime)
+            : owned(std::move(contents)), mapped(owned.data()), length(owned.size()),
+              device(dev), inode(ino), modified(mtime) {}
+        ~MappedFile();
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        // true se o arquivo encolheu em disco enquanto mapeado: parte do
+        // conteúdo lido pode ter virado zeros
+        [[nodiscard]] bool truncated() const;
+
+        // Confere o tamanho atual do arquivo (fstat); para quando um envio
+        // falhou com EFAULT. Retorna truncated().
+        bool checkTruncated() const;
+
+        [[nodiscard]] size_t size() const { return length; }
+        [[nodiscard]] timespec modifiedTime() const { return modified; }
+
+        // Identifica esta versão do arquivo (tamanho e mtime), opção "ver" do META
+        [[nodiscard]] std::string version() const;
+
+        // Assinatura de blocos (CHROMA_DELTA_BLOCK) para delta sync, guardada
+        // enquanto esta versão estiver viva. O primeiro pedido põe o cálculo
+        // no HashPool e, como os seguintes até ele acabar, recebe nullptr.
+        // Se o cálculo falhou (ex.: bad_alloc) fica nullptr e signatureFailed().
+        std::shared_ptr<const MappedFile> signature() const;
+        [[nodiscard]] bool signatureFailed() const;
+
+        // Árvore de Merkle do arquivo e as folhas dela servidas como arquivo;
+        // calculadas uma vez por versão no HashPool, como a assinatura
+        // (nullptr até a árvore ficar pronta ou se merkleTreeFailed())
+        std::shared_ptr<const MerkleTree> merkleTree() const;
+        std::shared_ptr<const MappedFile> merkleLeaves() const;
+        [[nodiscard]] bool merkleTreeFailed() const;
+        [[nodiscard]] std::span<const char> bytes() const { return {mapped, length}; }
+        [[nodiscard]] std::span<const char> chunk(uint64_t offset, size_t maxLen) const {
+            if (offset >= length) return {};
+            return {mapped + offset, std::min<size_t>(maxLen, length - offset)};
+        }
+
+    private:
+        friend class FileCache;
+        std::vector<char> owned;
+        const char* mapped;
+        size_t length;
+        dev_t device;
+        ino_t inode;
+        timespec modified;
+        int guard{-1};   // entrada na tabela do tratador de SIGBUS
+        int fd{-1};      // mantido aberto para checkTruncated()
+        mutable std::atomic<bool> shrunk{false};
+
+        // Andamento de um dado derivado calculado no HashPool
+        enum class Derivation { Idle, Running, Ready, Failed };
+
+        mutable std::mutex derivedMtx;
+        mutable std::shared_ptr<const MappedFile> blockSignature;
+        mutable Derivation signatureState{Derivation::Idle};
+        mutable std::shared_ptr<const MerkleTree> tree;
+        mutable Derivation treeState{Derivation::Idle};
+        mutable std::shared_ptr<const MappedFile> leaves;
+    };
+
+    struct Stats {
+        uint64_t hits{0};
+        uint64_t misses{0};
+        uint64_t evictions{0};
+        size_t cachedBytes{0};
+        size_t entries{0};
+    };
+
+    static FileCache& instance();
+
+    explicit FileCache(size_t budgetBytes = CHROMA_DEFAULT_CACHE_BYTES) : budget(budgetBytes) {}
+
+    // Mapeia (ou reaproveita) o arquivo; nullptr se não existe ou não abre.
+    // Um arquivo alterado em disco (inode/mtime/tamanho) é mapeado de novo.
+    std::shared_ptr<const MappedFile> acquire(const std::string& path);
+
+    void setBudget(size_t bytes);
+    [[nodiscard]] Stats stats() const;
+
+private:
+    using Key = std::pair<dev_t, ino_t>;
+
+    struct Entry {
+        Key key;
+        std::shared_ptr<const MappedFile> file;
+    };
+
+    mutable std::mutex mtx;
+    size_t budget;
+    std::list<Entry> lru;   // mais recente na frente
+    std::map<Key, std::list<Entry>::iterator> index;
+    Stats counters;
+
+    void evictLocked();
+};
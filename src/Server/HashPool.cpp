@@ -0,0 +1,48 @@
+#include "HashPool.hpp"
+
+#include <algorithm>
+
+HashPool& HashPool::instance() {
+    static HashPool pool;
+    return pool;
+}
+
+HashPool::HashPool(size_t threads) {
+    threads = std::max<size_t>(threads, 1);
+    workers.reserve(threads);
+    for (size_t i = 0; i < threads; ++i) {
+        workers.emplace_back([this]() { loop(); });
+    }
+}
+
+HashPool::~HashPool() {
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        stopping = true;
+        queue.clear();   // ninguém vai mais consultar o resultado
+    }
+    wake.notify_all();
+    for (std::thread& t : workers) t.join();
+}
+
+void HashPool::submit(std::function<void()> job) {
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        queue.push_back(std::move(job));
+    }
+    wake.notify_one();
+}
+
+void HashPool::loop() {
+    std::unique_lock<std::mutex> lock(mtx);
+    while (true) {
+        wake.wait(lock, [this]() { return stopping || !queue.empty(); });
+        if (stopping) break;
+
+        std::function<void()> job = std::move(queue.front());
+        queue.pop_front();
+        lock.unlock();
+        job();
+        lock.lock();
+    }
+}
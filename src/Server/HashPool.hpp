@@ -0,0 +1,40 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+constexpr size_t CHROMA_HASH_THREADS = 2;
+
+// Pool do processo para o que é calculado sobre o arquivo inteiro (assinatura
+// de blocos, árvore de Merkle). Essas passadas levam segundos em arquivos
+// grandes e não podem rodar na thread de um reactor, que pararia todas as
+// sessões do shard; o número fixo de threads impede que muitos pedidos ao
+// mesmo tempo tomem todos os núcleos. Não há aviso de conclusão: quem pediu
+// consulta o resultado de novo (a sessão faz isso no seu timer).
+class HashPool {
+public:
+    static HashPool& instance();
+
+    explicit HashPool(size_t threads = CHROMA_HASH_THREADS);
+    ~HashPool();
+
+    HashPool(const HashPool&) = delete;
+    HashPool& operator=(const HashPool&) = delete;
+
+    // O job trata as próprias falhas: exceção que escapa encerra o processo
+    void submit(std::function<void()> job);
+
+private:
+    std::mutex mtx;
+    std::condition_variable wake;
+    std::deque<std::function<void()>> queue;
+    bool stopping{false};
+    std::vector<std::thread> workers;
+
+    void loop();
+};
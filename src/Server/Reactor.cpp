@@ -0,0 +1,113 @@
+#include "Reactor.hpp"
+
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <chrono>
+#include <stdexcept>
+
+namespace {
+// Marcadores em epoll_event.data.ptr para os fds internos
+char timerTag;
+char wakeTag;
+}
+
+Reactor::Reactor() {
+    epollFd = epoll_create1(EPOLL_CLOEXEC);
+    timerFd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (epollFd < 0 || timerFd < 0 || wakeFd < 0) {
+        throw std::runtime_error("Erro ao criar epoll/timerfd/eventfd do reactor");
+    }
+
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.ptr = &timerTag;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, timerFd, &ev);
+    ev.data.ptr = &wakeTag;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeFd, &ev);
+
+    deferred.reserve(64);
+}
+
+Reactor::~Reactor() {
+    close(wakeFd);
+    close(timerFd);
+    close(epollFd);
+}
+
+void Reactor::add(int fd, Handler* handler, uint32_t events) {
+    epoll_event ev{};
+    ev.events = events;
+    ev.data.ptr = handler;
+    if (epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+        throw std::runtime_error("Erro ao registrar socket no epoll");
+    }
+}
+
+void Reactor::remove(int fd) {
+    epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr);
+}
+
+void Reactor::defer(Callback cb, void* ctx, uint64_t arg) {
+    deferred.push_back({cb, ctx, arg});
+}
+
+void Reactor::run() {
+    while (running) {
+        rearmTimer();
+
+        int n = epoll_wait(epollFd, events.data(), MAX_EVENTS, -1);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            throw std::runtime_error("Erro em epoll_wait");
+        }
+
+        for (int i = 0; i < n; ++i) {
+            void* ptr = events[i].data.ptr;
+            if (ptr == &timerTag) {
+                uint64_t expirations;
+                (void)read(timerFd, &expirations, sizeof(expirations));
+                armedDeadline = TimingWheel::TimePoint::max();
+            } else if (ptr == &wakeTag) {
+                uint64_t value;
+                (void)read(wakeFd, &value, sizeof(value));
+            } else {
+                static_cast<Handler*>(ptr)->onEvent(events[i].events);
+            }
+        }
+
+        // Timers vencidos rodam depois dos sockets: ACKs que chegaram junto
+        // com o prazo têm a chance de cancelar a retransmissão
+        wheel.advance(TimingWheel::Clock::now());
+
+        for (size_t i = 0; i < deferred.size(); ++i) {
+            deferred[i].cb(deferred[i].ctx, deferred[i].arg);
+        }
+        deferred.clear();
+    }
+}
+
+void Reactor::stop() {
+    running = false;
+    uint64_t one = 1;
+    (void)write(wakeFd, &one, sizeof(one));
+}
+
+void Reactor::rearmTimer() {
+    auto deadline = wheel.nextDeadline();
+    if (deadline == armedDeadline) return;
+
+    itimerspec spec{};
+    if (deadline != TimingWheel::TimePoint::max()) {
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(deadline.time_since_epoch()).count();
+        if (ns <= 0) ns = 1;   // zero desarmaria o timerfd
+        spec.it_value.tv_sec = static_cast<time_t>(ns / 1'000'000'000);
+        spec.it_value.tv_nsec = static_cast<long>(ns % 1'000'000'000);
+    }
+    // steady_clock no Linux é CLOCK_MONOTONIC, então o prazo vai em tempo absoluto
+    timerfd_settime(timerFd, TFD_TIMER_ABSTIME, &spec, nullptr);
+    armedDeadline = deadline;
+}
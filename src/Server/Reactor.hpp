@@ -0,0 +1,66 @@
+#pragma once
+
+#include "../Protocol/TimingWheel.hpp"
+
+#include <sys/epoll.h>
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+// Laço de eventos de uma thread: epoll para os sockets e um único timerfd
+// armado no próximo prazo da roda de timers local. A thread só acorda quando
+// há datagrama para ler ou timer vencido; nada de espera ativa.
+class Reactor {
+public:
+    using Callback = TimingWheel::Callback;
+
+    class Handler {
+    public:
+        virtual ~Handler() = default;
+        virtual void onEvent(uint32_t events) = 0;
+    };
+
+    Reactor();
+    ~Reactor();
+
+    Reactor(const Reactor&) = delete;
+    Reactor& operator=(const Reactor&) = delete;
+
+    void add(int fd, Handler* handler, uint32_t events = EPOLLIN);
+    void remove(int fd);
+
+    // Timers das sessões deste reactor; disparam na thread do laço
+    [[nodiscard]] TimingWheel& timers() { return wheel; }
+
+    // Executa `cb(ctx, arg)` ao fim da rodada de eventos corrente, quando
+    // nenhum handler está mais em uso (ex.: destruir uma sessão encerrada)
+    void defer(Callback cb, void* ctx, uint64_t arg);
+
+    // Roda até stop(); stop() pode ser chamado de qualquer thread, inclusive
+    // antes de run()
+    void run();
+    void stop();
+
+private:
+    static constexpr int MAX_EVENTS = 256;
+
+    struct Deferred {
+        Callback cb;
+        void* ctx;
+        uint64_t arg;
+    };
+
+    int epollFd{-1};
+    int timerFd{-1};
+    int wakeFd{-1};
+    std::atomic<bool> running{true};   // stop() antes de run() também vale
+
+    TimingWheel wheel;
+    TimingWheel::TimePoint armedDeadline{TimingWheel::TimePoint::max()};
+    std::vector<Deferred> deferred;
+    std::array<epoll_event, MAX_EVENTS> events{};
+
+    void rearmTimer();
+};
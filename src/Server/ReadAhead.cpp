@@ -0,0 +1,75 @@
+#include "ReadAhead.hpp"
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+PrefetchWorker::PrefetchWorker() {
+    worker = std::thread([this]() { loop(); });
+}
+
+PrefetchWorker::~PrefetchWorker() {
+    running.store(false, std::memory_order_release);
+    signal.fetch_add(1, std::memory_order_release);
+    signal.notify_one();
+    if (worker.joinable()) worker.join();
+}
+
+void PrefetchWorker::request(const std::shared_ptr<ReadAheadStream>& stream) {
+    if (stream->queued.exchange(true, std::memory_order_acq_rel)) return;
+    if (!jobs.push(stream)) {
+        stream->queued.store(false, std::memory_order_release);   // tenta de novo no próximo pump
+        return;
+    }
+    signal.fetch_add(1, std::memory_order_release);
+    signal.notify_one();
+}
+
+void PrefetchWorker::loop() {
+    std::shared_ptr<ReadAheadStream> stream;
+    while (running.load(std::memory_order_acquire)) {
+        uint32_t seen = signal.load(std::memory_order_acquire);
+
+        while (jobs.pop(stream)) {
+            stream->queued.store(false, std::memory_order_release);
+            if (!stream->cancelled.load(std::memory_order_acquire)) {
+                fill(*stream);
+            }
+            stream.reset();
+        }
+
+        signal.wait(seen, std::memory_order_acquire);
+    }
+}
+
+void PrefetchWorker::fill(ReadAheadStream& stream) {
+    static const size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    std::span<const char> bytes = stream.file->bytes();
+    size_t size = stream.end;
+
+    while (stream.prefetched < size && !stream.cancelled.load(std::memory_order_relaxed)) {
+        size_t length = std::min<size_t>(stream.chunkSize, size - stream.prefetched);
+        const char* begin = bytes.data() + stream.prefetched;
+
+        // Pede a leitura assíncrona de blocos grandes à frente...
+        if (stream.prefetched + length > stream.advised) {
+            uintptr_t from = reinterpret_cast<uintptr_t>(bytes.data() + stream.advised) & ~(pageSize - 1);
+            stream.advised = std::min<uint64_t>(size, stream.prefetched + CHROMA_ADVISE_BYTES);
+            uintptr_t to = reinterpret_cast<uintptr_t>(bytes.data() + stream.advised);
+            madvise(reinterpret_cast<void*>(from), to - from, MADV_WILLNEED);
+        }
+
+        // ...e toca cada página do chunk para só entregá-lo já residente
+        for (size_t off = 0; off < length; off += pageSize) {
+            (void)*reinterpret_cast<const volatile char*>(begin + off);
+        }
+        (void)*reinterpret_cast<const volatile char*>(begin + length - 1);
+
+        if (!stream.ready.push({stream.prefetched, static_cast<uint32_t>(length)})) {
+            return;   // fila cheia: o reactor pede mais quando consumir
+        }
+        stream.prefetched += length;
+    }
+    if (stream.prefetched >= size) {
+        stream.exhausted.store(true, std::memory_order_release);
+    }
+}
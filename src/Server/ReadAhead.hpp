@@ -0,0 +1,85 @@
+#pragma once
+
+#include "../Protocol/SpscQueue.hpp"
+#include "FileCache.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <thread>
+
+constexpr size_t CHROMA_DEFAULT_READAHEAD_CHUNKS = 512;
+constexpr size_t CHROMA_PREFETCH_JOBS = 4096;   // sessões com pedido pendente por worker
+constexpr size_t CHROMA_ADVISE_BYTES = 2 * 1024 * 1024;   // alcance de cada MADV_WILLNEED
+
+// Leitura antecipada de um arquivo mapeado. Um PrefetchWorker em segundo
+// plano traz as páginas dos próximos chunks para a memória (madvise + toque
+// em cada página) e entrega os chunks prontos numa fila SPSC; o reactor só
+// consome páginas já residentes e nunca para num page fault de disco.
+class ReadAheadStream {
+public:
+    struct Chunk {
+        uint64_t offset{0};
+        uint32_t length{0};
+    };
+
+    // Lê os bytes [offset, end) do arquivo, limitados ao tamanho dele
+    ReadAheadStream(std::shared_ptr<const FileCache::MappedFile> file, size_t chunkSize, size_t depth,
+                    uint64_t offset = 0, uint64_t end = UINT64_MAX)
+        : file(std::move(file)), chunkSize(chunkSize), ready(depth),
+          end(std::min<uint64_t>(end, this->file->size())), prefetched(offset), advised(offset) {}
+
+    // Próximo chunk já residente, em ordem; false se o worker ainda não chegou lá
+    bool next(std::span<const char>& out) {
+        Chunk c;
+        if (!ready.pop(c)) return false;
+        out = file->chunk(c.offset, c.length);
+        return true;
+    }
+
+    // Vale a pena acordar o worker: a fila esvaziou até a metade
+    [[nodiscard]] bool wantsMore() const {
+        return !exhausted.load(std::memory_order_acquire) && ready.size() <= ready.capacity() / 2;
+    }
+
+    void cancel() { cancelled.store(true, std::memory_order_release); }
+
+private:
+    friend class PrefetchWorker;
+
+    std::shared_ptr<const FileCache::MappedFile> file;
+    size_t chunkSize;
+    SpscQueue<Chunk> ready;          // worker -> sessão
+    uint64_t end;
+
+    uint64_t prefetched;             // só o worker mexe
+    uint64_t advised;
+    std::atomic<bool> exhausted{false};
+    std::atomic<bool> cancelled{false};
+    std::atomic<bool> queued{false}; // já está na fila de pedidos do worker
+};
+
+// Uma thread de I/O por reactor. Pedidos chegam por SPSC (o reactor é o
+// único produtor) e a thread dorme em std::atomic::wait quando não há nada.
+class PrefetchWorker {
+public:
+    PrefetchWorker();
+    ~PrefetchWorker();
+
+    PrefetchWorker(const PrefetchWorker&) = delete;
+    PrefetchWorker& operator=(const PrefetchWorker&) = delete;
+
+    // Pede para completar a fila do stream; só a thread do reactor chama
+    void request(const std::shared_ptr<ReadAheadStream>& stream);
+
+private:
+    SpscQueue<std::shared_ptr<ReadAheadStream>> jobs{CHROMA_PREFETCH_JOBS};
+    std::atomic<uint32_t> signal{0};
+    std::atomic<bool> running{true};
+    std::thread worker;
+
+    void loop();
+    void fill(ReadAheadStream& stream);
+};
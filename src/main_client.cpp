@@ -1,27 +1,60 @@
-
 #include <iostream>
+#include <stdexcept>
+#include <string>
 #include "Server/ChromaServer.hpp"
 #include "Client/ChromaClient.hpp"
+#include "Client/ParallelDownload.hpp"
+
+int main(int argc, char* argv[]) {
+    size_t streams = 1;   // >1: cada arquivo em trechos paralelos
+    bool delta = true;    // reaproveita a cópia antiga da saída, se houver
+    bool compress = true; // oferece compressão por chunk ao servidor
+
+    auto usage = [&]() {
+        std::cerr << "Uso: " << argv[0] << " [--streams=N] [--no-delta] [--no-compress]" << std::endl;
+        return 1;
+    };
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg.rfind("--streams=", 0) == 0) {
+            // stoul aceitaria "-1" (vira um número enorme) e "4x"
+            std::string value = arg.substr(10);
+            size_t used = 0;
+            try {
+                streams = std::stoul(value, &used);
+            } catch (const std::logic_error&) {   // invalid_argument, out_of_range
+                return usage();
+            }
+            if (used != value.size() || value.find('-') != std::string::npos) return usage();
+        } else if (arg == "--no-delta") {
+            delta = false;
+        } else if (arg == "--no-compress") {
+            compress = false;
+        } else {
+            return usage();
+        }
+    }
 
-int main() {
+    // Mesmo com um stream o download passa pelo ParallelDownload, que mantém
+    // o diário e retoma downloads interrompidos
+    ParallelDownload parallel("127.0.0.1", 8080, WIDE_WINDOW_SIZE, streams);
+    parallel.setPacketLossChance(10);
+    parallel.setDeltaSync(delta);
+    parallel.setCompression(compress);
 
-    ChromaClient client(WINDOW_SIZE);
-    client.connectToServer("127.0.0.1", 8080);
-    
     std::string filename;
     char choice = 's';
 
-    client.setQuietMode(false);
-    client.setPacketLossChance(10); 
-    while (choice == 's' && client.isConnected()) {
+    while (choice == 's') {
         std::cout << "Digite o nome do arquivo a ser solicitado: ";
         std::cin >> filename;
 
-        client.sendData(filename.c_str(), filename.size());
+        parallel.fetch(filename);
 
         std::cout << "Deseja solicitar outro arquivo? (s/n): ";
         std::cin >> choice;
     }
 
     return 0;
-}
\ No newline at end of file
+}
@@ -1,12 +1,103 @@
+#include <charconv>
+#include <cstdint>
 #include <iostream>
-#include "Server/ChromaServiceHost.hpp"
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include "Protocol/CongestionControl.hpp"
+#include "Protocol/ErasureCode.hpp"
+#include "Server/ChromaShardGroup.hpp"
+#include "Server/FileCache.hpp"
 
-int main() {
-    int windowSize = WINDOW_SIZE;
+namespace {
+// Número decimal inteiro em [min, max]; sinal, sobra de texto ou valor fora
+// da faixa falham, em vez de uma exceção derrubar o servidor
+template <typename T>
+bool parseNumber(const std::string& text, T min, T max, T& out) {
+    uint64_t value = 0;
+    const char* end = text.data() + text.size();
+    auto [ptr, ec] = std::from_chars(text.data(), end, value);
+    if (ec != std::errc() || ptr != end || text.empty()) return false;
+    if (value < static_cast<uint64_t>(min) || value > static_cast<uint64_t>(max)) return false;
+    out = static_cast<T>(value);
+    return true;
+}
+}
+
+int main(int argc, char* argv[]) {
+    int windowSize = WIDE_WINDOW_SIZE;
     int port = 8080;
+    std::string congestion = "newreno";
+    unsigned shards = 0;   // 0 = um por núcleo
+    int maxSessions = CHROMA_DEFAULT_MAX_SESSIONS;
+    size_t queueDepth = CHROMA_DEFAULT_PENDING_DEPTH;
+    size_t cacheBytes = CHROMA_DEFAULT_CACHE_BYTES;
+    size_t readAhead = CHROMA_DEFAULT_READAHEAD_CHUNKS;
+    uint32_t fecBlock = 0;   // 0 = sem FEC
+    uint32_t fecParity = CHROMA_FEC_DEFAULT_PARITY;
+
+    auto usage = [&]() {
+        std::cerr << "Uso: " << argv[0] << " [--cc=newreno|vegas] [--shards=N]"
+                  << " [--max-sessions=N] [--queue=N] [--cache-mb=N]"
+                  << " [--readahead=N] [--fec[=K[,M]]]" << std::endl;
+        return 1;
+    };
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg.rfind("--cc=", 0) == 0) {
+            congestion = arg.substr(5);
+        } else if (arg.rfind("--shards=", 0) == 0) {
+            if (!parseNumber(arg.substr(9), 0u, CHROMA_MAX_SHARDS, shards)) return usage();
+        } else if (arg.rfind("--max-sessions=", 0) == 0) {
+            if (!parseNumber(arg.substr(15), 1, std::numeric_limits<int>::max(), maxSessions)) return usage();
+        } else if (arg.rfind("--queue=", 0) == 0) {
+            if (!parseNumber(arg.substr(8), size_t{0}, std::numeric_limits<size_t>::max(), queueDepth)) {
+                return usage();
+            }
+        } else if (arg.rfind("--cache-mb=", 0) == 0) {
+            size_t megabytes = 0;
+            constexpr size_t MB = 1024 * 1024;
+            if (!parseNumber(arg.substr(11), size_t{0}, std::numeric_limits<size_t>::max() / MB, megabytes)) {
+                return usage();
+            }
+            cacheBytes = megabytes * MB;
+        } else if (arg.rfind("--readahead=", 0) == 0) {
+            if (!parseNumber(arg.substr(12), size_t{0}, std::numeric_limits<size_t>::max(), readAhead)) {
+                return usage();
+            }
+        } else if (arg == "--fec") {
+            fecBlock = CHROMA_FEC_DEFAULT_BLOCK;
+        } else if (arg.rfind("--fec=", 0) == 0) {
+            // --fec=K ou --fec=K,M: K pacotes por bloco (0 desliga), no máximo M paridades
+            std::string spec = arg.substr(6);
+            size_t comma = spec.find(',');
+            if (!parseNumber(spec.substr(0, comma), 0u, CHROMA_FEC_MAX_BLOCK, fecBlock)) return usage();
+            if (comma != std::string::npos &&
+                !parseNumber(spec.substr(comma + 1), 1u, CHROMA_FEC_MAX_PARITY, fecParity)) {
+                return usage();
+            }
+        } else {
+            return usage();
+        }
+    }
+
+    // Algoritmo desconhecido só apareceria na primeira sessão, uma exceção por GET
+    try {
+        makeCongestionController(congestion);
+    } catch (const std::invalid_argument& e) {
+        std::cerr << e.what() << std::endl;
+        return usage();
+    }
+
+    FileCache::instance().setBudget(cacheBytes);
 
-    ChromaServiceHost serverManager(windowSize, port);
+    ChromaShardGroup serverManager(windowSize, port, shards);
+    serverManager.setCongestionControl(congestion);
+    serverManager.setAdmissionLimits(maxSessions, queueDepth);
+    serverManager.setReadAhead(readAhead);
+    serverManager.setFec(fecBlock, fecParity);
     serverManager.start();
 
     return 0;
-}
\ No newline at end of file
+}